@@ -4,6 +4,9 @@ use IEEE.STD_LOGIC_ARITH.ALL;
 use IEEE.STD_LOGIC_UNSIGNED.ALL;
 
 entity i8051_top is 
+generic (
+		ROM_IMAGE	 : integer := 0;			-- int_rom program, see int_rom.vhd
+		BRANCH_PREDICT	 : boolean := true);
 port (
         	clk          : in  std_logic;
         	rst          : in  std_logic;
@@ -19,25 +22,35 @@ port (
         	p3_in        : in  std_logic_vector (7 downto 0);
         	p3_out       : out std_logic_vector (7 downto 0);
 		
-		pc_debug	 : out std_logic_vector (15 downto 0));
+		pc_debug	 : out std_logic_vector (15 downto 0);
+
+		trace_mode	 : in  std_logic;			-- 0: every instruction, 1: taken branches only
+		trace_rd	 : in  std_logic;
+		trace_data	 : out std_logic_vector (33 downto 0);
+		trace_valid	 : out std_logic;
+		trace_ovf	 : out std_logic;
+		trace_state	 : out std_logic_vector (23 downto 0);	-- ACC, PSW, SP after the record on trace_data
+		trace_wr	 : out std_logic_vector (27 downto 0));	-- RAM/SFR byte writes of that instruction
 		--testing	: in std_logic_vector (1 downto 0));
 end i8051_top;
 
 architecture Behavioral of i8051_top is
 	component sequencer2 is  
+	generic (BRANCH_PREDICT : boolean := true);
 	port(
 		rst              	: in  std_logic;
 		clk              	: in  std_logic;
 		ale		  	: out std_logic;
 		psen		 	: out std_logic;
 		
-		alu_op_code	 	: out  std_logic_vector (3 downto 0);
+		alu_op_code	 	: out  std_logic_vector (4 downto 0);
 		alu_src_1L		: out  std_logic_vector (7 downto 0);
 		alu_src_1H		: out  std_logic_vector (7 downto 0);
 		alu_src_2L		: out  std_logic_vector (7 downto 0);
 		alu_src_2H		: out  std_logic_vector (7 downto 0);	
 		alu_by_wd		: out  std_logic;             -- byte(0)/word(1) instruction
 		alu_cy_bw		: out  std_logic;             -- carry/borrow bit
+		alu_ac_in		: out  std_logic;             -- auxiliary carry for DA
 		alu_ans_L		: in std_logic_vector (7 downto 0);
 		alu_ans_H		: in std_logic_vector (7 downto 0);
 		alu_cy		: in std_logic;				-- carry out of bit 7/15
@@ -49,6 +62,7 @@ architecture Behavioral of i8051_top is
 		quotient_o		: in std_logic_vector(15 downto 0); 
 		remainder_o	 	: in std_logic_vector(15 downto 0);
 		div_done		: in std_logic ;
+		div_start		: out std_logic;
 
 		mul_a_i		: out std_logic_vector(15 downto 0);	-- Multiplicand
 		mul_b_i		: out std_logic_vector(15 downto 0);	-- Multiplicator
@@ -63,6 +77,11 @@ architecture Behavioral of i8051_top is
 		i_ram_diBit   	: out std_logic; 
 		i_ram_doByte   	: in std_logic_vector(7 downto 0); 
 		i_ram_doBit   	: in std_logic; 
+		i_ram_ind		: out std_logic; 
+		i_ram_bitOp		: out std_logic_vector(2 downto 0); 
+		i_ram_pair		: out std_logic; 
+		i_ram_diHi		: out std_logic_vector(7 downto 0); 
+		i_ram_doHi		: in std_logic_vector(7 downto 0); 
 		
 	    	i_rom_addr        : out std_logic_vector (15 downto 0);
 	    	i_rom_data        : in  std_logic_vector (7 downto 0);
@@ -70,18 +89,42 @@ architecture Behavioral of i8051_top is
 		
 		pc_debug	 	: out std_logic_vector (15 downto 0);
 		interrupt_flag	: in  std_logic_vector (2 downto 0);
-		erase_flag	 	: out std_logic);
+		erase_flag	 	: out std_logic;
+		
+		instr_retire	: out std_logic;
+		div_wait		: out std_logic;
+		ram_access		: out std_logic;
+		
+		trace_pc		: out std_logic_vector (15 downto 0);
+		trace_ir		: out std_logic_vector (7 downto 0);
+		trace_taken		: out std_logic;
+		illegal_op		: out std_logic;
+		pred_hit		: out std_logic;
+		pred_miss		: out std_logic;
+
+		dptr_inc		: out std_logic;
+		dptr_ld		: out std_logic;
+		dptr_di		: out std_logic_vector (15 downto 0);
+		dptr			: in  std_logic_vector (15 downto 0);
+
+		sp_ld			: out std_logic;
+		sp_di			: out std_logic_vector (7 downto 0);
+		sp			: in  std_logic_vector (7 downto 0);
+
+		div_wb			: out std_logic;
+		div_ov			: out std_logic);
 
 	end component;
 
 	component fastalu is port (
-		op_code	: in  std_logic_vector (3 downto 0);
+		op_code	: in  std_logic_vector (4 downto 0);
 	 	src_1L	: in  std_logic_vector (7 downto 0);
 		src_1H	: in  std_logic_vector (7 downto 0);
 		src_2L	: in  std_logic_vector (7 downto 0);
 		src_2H	: in  std_logic_vector (7 downto 0);
 		by_wd		: in  std_logic;             -- byte(0)/word(1) instruction
 		cy_bw		: in  std_logic;             -- carry/borrow bit
+		ac_in		: in  std_logic;             -- auxiliary carry, used by DA
 		ans_L		: out std_logic_vector (7 downto 0);
 		ans_H		: out std_logic_vector (7 downto 0);
 	 	alu_cy	: out std_logic;            -- carry out of bit 7/15
@@ -94,6 +137,7 @@ architecture Behavioral of i8051_top is
 	 	rst		:	in std_logic;
 		clk		:	in std_logic;
 		addr 		: 	in std_logic_vector(7 downto 0);
+		ind		:	in std_logic;
 		wrBit		:	in std_logic;
 		wrByte	:	in std_logic;
 		rdBit		:	in std_logic;
@@ -101,6 +145,7 @@ architecture Behavioral of i8051_top is
 		
 		diBit		:	in std_logic;
 		diByte	:	in std_logic_vector(7 downto 0);
+		bitOp		:	in std_logic_vector(2 downto 0);
 
 		doBit		:	out std_logic;
 		doByte	:	out std_logic_vector(7 downto 0);
@@ -118,7 +163,23 @@ architecture Behavioral of i8051_top is
 		P0_in		:	in std_logic_vector(7 downto 0);
 		P1_in		:	in std_logic_vector(7 downto 0);
 		P2_in		:	in std_logic_vector(7 downto 0);
-		P3_in		:	in std_logic_vector(7 downto 0));
+		P3_in		:	in std_logic_vector(7 downto 0);
+
+		dptr_inc	:	in std_logic;
+		dptr_ld	:	in std_logic;
+		dptr_di	:	in std_logic_vector(15 downto 0);
+		dptr		:	out std_logic_vector(15 downto 0);
+
+		sp_ld		:	in std_logic;
+		sp_di		:	in std_logic_vector(7 downto 0);
+		SP_out	:	out std_logic_vector(7 downto 0);
+		ACC_out	:	out std_logic_vector(7 downto 0);
+		PSW_out	:	out std_logic_vector(7 downto 0);
+
+		div_wb	:	in std_logic;
+		div_ov	:	in std_logic;
+		div_q		:	in std_logic_vector(7 downto 0);
+		div_r		:	in std_logic_vector(7 downto 0));
 	end component;
 
 	component multiplier is
@@ -131,6 +192,8 @@ architecture Behavioral of i8051_top is
 	end component;
 
 	component int_rom is
+	generic (ADDR_WIDTH : integer := 12;
+		 IMAGE      : integer := 0);
 	port(
 	    clk      : in  std_logic;
 		rst      : in  std_logic;
@@ -140,6 +203,7 @@ architecture Behavioral of i8051_top is
 	end component;
 
 	component internal_ram is 
+	 generic (CLEAR_ON_RESET : boolean := true);
 	 port (
 		clk 	 	: in std_logic;
 		rst 	 	: in std_logic; 
@@ -150,21 +214,29 @@ architecture Behavioral of i8051_top is
 	 	rdBit    	: in std_logic; 
 
 	 	addr 	 	: in std_logic_vector(7 downto 0); 
+	 	ind 	 	: in std_logic; 
 
 	 	diByte   	: in std_logic_vector(7 downto 0); 
 	 	diBit    	: in std_logic; 
+	 	bitOp    	: in std_logic_vector(2 downto 0); 
 	 	doByte   	: out std_logic_vector(7 downto 0); 
-	 	doBit    	: out std_logic); 
+	 	doBit    	: out std_logic;
+	 	pair    	: in std_logic; 
+	 	diHi     	: in std_logic_vector(7 downto 0); 
+	 	doHi     	: out std_logic_vector(7 downto 0); 
+	 	busy     	: out std_logic); 
 	 end component; 
 
 	 component divider is  
 	  port (
 	  	clk		: in  std_logic;
 	  	reset		: in  std_logic;
+	  	start		: in  std_logic;
 	  	dividend_i	: in  std_logic_vector(15 downto 0);
 		divisor_i	: in  std_logic_vector(15 downto 0);
 		quotient_o	: out std_logic_vector(15 downto 0); 
 		remainder_o	: out std_logic_vector(15 downto 0);
+		busy		: out std_logic;
 		done		: out std_logic);
 	end component;
 
@@ -175,16 +247,94 @@ architecture Behavioral of i8051_top is
           	IE_reg : in std_logic_vector(7 downto 0);
           	SCON_reg : in std_logic_vector(7 downto 0);
           	TCON_reg : in std_logic_vector(7 downto 0);
+          	mdu_irq : in std_logic;
           	int_select : out std_logic_vector(2 downto 0));
 	end component;
 
-signal alu_op_code	 : std_logic_vector (3 downto 0);
+	component perf_counter is
+	port (
+		rst		:	in std_logic;
+		clk		:	in std_logic;
+		addr		:	in std_logic_vector(7 downto 0);
+		ind		:	in std_logic;
+		wrByte	:	in std_logic;
+		rdByte	:	in std_logic;
+		diByte	:	in std_logic_vector(7 downto 0);
+		doByte	:	out std_logic_vector(7 downto 0);
+		
+		ev_retire	:	in std_logic;
+		ev_div_wait	:	in std_logic;
+		ev_ram	:	in std_logic;
+		ev_illegal	:	in std_logic;
+		ev_pred_hit	:	in std_logic;
+		ev_pred_miss	:	in std_logic);
+	end component;
+
+	component mdu is
+	port (
+		rst		:	in std_logic;
+		clk		:	in std_logic;
+		addr		:	in std_logic_vector(7 downto 0);
+		ind		:	in std_logic;
+		wrByte	:	in std_logic;
+		diByte	:	in std_logic_vector(7 downto 0);
+		doByte	:	out std_logic_vector(7 downto 0);
+		irq		:	out std_logic);
+	end component;
+
+	component read_mux is
+	port (
+		clk		:	in std_logic;
+		addr		:	in std_logic_vector(7 downto 0);
+		ind		:	in std_logic;
+		ram_byte	:	in std_logic_vector(7 downto 0);
+		ram_bit	:	in std_logic;
+		sfr_byte	:	in std_logic_vector(7 downto 0);
+		sfr_bit	:	in std_logic;
+		pm_byte	:	in std_logic_vector(7 downto 0);
+		mdu_byte	:	in std_logic_vector(7 downto 0);
+		doByte	:	out std_logic_vector(7 downto 0);
+		doBit		:	out std_logic);
+	end component;
+
+	component trace_port is
+	generic (DEPTH_LOG2 : integer := 4);
+	port (
+		clk		:	in std_logic;
+		rst		:	in std_logic;
+		mode		:	in std_logic;
+		
+		retire	:	in std_logic;
+		ret_pc	:	in std_logic_vector(15 downto 0);
+		ret_ir	:	in std_logic_vector(7 downto 0);
+		ret_taken	:	in std_logic;
+		next_pc	:	in std_logic_vector(15 downto 0);
+		ret_acc	:	in std_logic_vector(7 downto 0);
+		ret_psw	:	in std_logic_vector(7 downto 0);
+		ret_sp	:	in std_logic_vector(7 downto 0);
+		wr		:	in std_logic;
+		wr_addr	:	in std_logic_vector(7 downto 0);
+		wr_ind	:	in std_logic;
+		wr_pair	:	in std_logic;
+		wr_data	:	in std_logic_vector(7 downto 0);
+		wr_hi		:	in std_logic_vector(7 downto 0);
+		
+		rd		:	in std_logic;
+		data		:	out std_logic_vector(33 downto 0);
+		valid		:	out std_logic;
+		ovf		:	out std_logic;
+		state		:	out std_logic_vector(23 downto 0);
+		writes	:	out std_logic_vector(27 downto 0));
+	end component;
+
+signal alu_op_code	 : std_logic_vector (4 downto 0);
 signal alu_src_1L		 : std_logic_vector (7 downto 0);
 signal alu_src_1H		 : std_logic_vector (7 downto 0);
 signal alu_src_2L		 : std_logic_vector (7 downto 0);
 signal alu_src_2H		 : std_logic_vector (7 downto 0);
 signal alu_by_wd		 : std_logic;				-- byte(0)/word(1) instruction
 signal alu_cy_bw		 : std_logic;				-- carry/borrow bit
+signal alu_ac_in		 : std_logic;				-- auxiliary carry for DA
 signal alu_ans_L		 : std_logic_vector (7 downto 0);
 signal alu_ans_H		 : std_logic_vector (7 downto 0);
 signal alu_cy		 : std_logic;				-- carry out of bit 7/15
@@ -196,6 +346,9 @@ signal divisor_i		 : std_logic_vector(15 downto 0);
 signal quotient_o		 : std_logic_vector(15 downto 0); 
 signal remainder_o	 : std_logic_vector(15 downto 0);
 signal div_done		 : std_logic ;
+signal div_start		 : std_logic;
+signal div_wb		 : std_logic;				-- DIV AB result to A, B and PSW
+signal div_ov		 : std_logic;
 
 signal mul_a_i		 : std_logic_vector(15 downto 0);	-- Multiplicand
 signal mul_b_i		 : std_logic_vector(15 downto 0);	-- Multiplicator
@@ -210,6 +363,15 @@ signal i_ram_diByte  	 : std_logic_vector(7 downto 0);
 signal i_ram_diBit   	 : std_logic; 
 signal i_ram_doByte   	 : std_logic_vector(7 downto 0); 
 signal i_ram_doBit   	 : std_logic; 
+signal ram_doByte		 : std_logic_vector(7 downto 0);	-- read data of each slave, see read_mux
+signal ram_doBit		 : std_logic;
+signal sfr_doByte		 : std_logic_vector(7 downto 0);
+signal sfr_doBit		 : std_logic;
+signal pm_doByte		 : std_logic_vector(7 downto 0);
+signal mdu_doByte		 : std_logic_vector(7 downto 0);
+signal mdu_irq		 : std_logic;
+signal i_ram_ind   	 : std_logic; 
+signal i_ram_bitOp   	 : std_logic_vector(2 downto 0); 
 
 signal i_rom_addr        : std_logic_vector (15 downto 0);
 signal i_rom_data        : std_logic_vector (7 downto 0);
@@ -222,7 +384,33 @@ signal tcon_reg		 : std_logic_vector (7 downto 0);
 signal i_flag	 	:  std_logic_vector (2 downto 0);
 signal clear_flag 	: std_logic;
 
+signal instr_retire	: std_logic;
+signal div_wait		: std_logic;
+signal ram_access		: std_logic;
+
+signal pc_cur		: std_logic_vector(15 downto 0);
+signal trace_pc		: std_logic_vector(15 downto 0);
+signal trace_ir		: std_logic_vector(7 downto 0);
+signal trace_taken	: std_logic;
+signal illegal_op		: std_logic;
+signal pred_hit		: std_logic;
+signal pred_miss		: std_logic;
+signal dptr_inc		: std_logic;
+signal dptr_ld		: std_logic;
+signal dptr_di		: std_logic_vector(15 downto 0);
+signal dptr			: std_logic_vector(15 downto 0);
+signal i_ram_pair		: std_logic;
+signal i_ram_diHi		: std_logic_vector(7 downto 0);
+signal i_ram_doHi		: std_logic_vector(7 downto 0);
+signal sp_ld		: std_logic;
+signal sp_di		: std_logic_vector(7 downto 0);
+signal sp_reg		: std_logic_vector(7 downto 0);
+signal acc_reg		: std_logic_vector(7 downto 0);
+signal psw_reg		: std_logic_vector(7 downto 0);
+
 signal rst_bar          : std_logic;
+signal ram_busy		: std_logic;	-- internal_ram still clearing after reset
+signal seq_rst		: std_logic;
 signal p0_out_bar		: std_logic_vector(7 downto 0);
 signal p1_out_bar		: std_logic_vector(7 downto 0);
 signal p2_out_bar		: std_logic_vector(7 downto 0);
@@ -233,6 +421,7 @@ signal counter2 		: std_logic_vector(2 downto 0) ; -- orignal is 17 down to 0
 begin
 
 	rst_bar <= not rst;
+	seq_rst <= rst_bar or ram_busy;
 	p0_out <= not p0_out_bar;
 	p1_out <= not p1_out_bar;
 	p2_out <= not p2_out_bar;
@@ -251,47 +440,82 @@ begin
 	end process;
 
 SEQ:sequencer2
-	port map(rst_bar, clk_div, ale, psen,
+	generic map(BRANCH_PREDICT)
+	port map(seq_rst, clk_div, ale, psen,
 	alu_op_code, alu_src_1L, alu_src_1H, alu_src_2L, alu_src_2H, 
-	alu_by_wd, alu_cy_bw, alu_ans_L, alu_ans_H, alu_cy, alu_ac, alu_ov,
-	dividend_i, divisor_i, quotient_o, remainder_o, div_done,
+	alu_by_wd, alu_cy_bw, alu_ac_in, alu_ans_L, alu_ans_H, alu_cy, alu_ac, alu_ov,
+	dividend_i, divisor_i, quotient_o, remainder_o, div_done, div_start,
 	mul_a_i, mul_b_i, mul_prod_o,
 	i_ram_wrByte, i_ram_wrBit, i_ram_rdByte, i_ram_rdBit, i_ram_addr, 
-	i_ram_diByte, i_ram_diBit, i_ram_doByte, i_ram_doBit,
+	i_ram_diByte, i_ram_diBit, i_ram_doByte, i_ram_doBit, i_ram_ind, i_ram_bitOp,
+	i_ram_pair, i_ram_diHi, i_ram_doHi,
 	i_rom_addr, i_rom_data, i_rom_rd,
-	pc_debug, i_flag, clear_flag);
+	pc_cur, i_flag, clear_flag,
+	instr_retire, div_wait, ram_access,
+	trace_pc, trace_ir, trace_taken, illegal_op, pred_hit, pred_miss,
+	dptr_inc, dptr_ld, dptr_di, dptr,
+	sp_ld, sp_di, sp_reg,
+	div_wb, div_ov);
 	
 ALU1:fastalu
 	port map(alu_op_code, alu_src_1L, alu_src_1H, alu_src_2L, alu_src_2H, 
-	alu_by_wd, alu_cy_bw, alu_ans_L, alu_ans_H, alu_cy, alu_ac, alu_ov);
+	alu_by_wd, alu_cy_bw, alu_ac_in, alu_ans_L, alu_ans_H, alu_cy, alu_ac, alu_ov);
 	
 REG:regfile
 	port map(rst_bar, clk_div,
-	i_ram_addr, i_ram_wrBit, i_ram_wrByte, i_ram_rdBit, i_ram_rdByte,
-	i_ram_diBit, i_ram_diByte, 
-	i_ram_doBit, i_ram_doByte,
+	i_ram_addr, i_ram_ind, i_ram_wrBit, i_ram_wrByte, i_ram_rdBit, i_ram_rdByte,
+	i_ram_diBit, i_ram_diByte, i_ram_bitOp,
+	sfr_doBit, sfr_doByte,
 	p0_out_bar, p1_out_bar, p2_out_bar, p3_out_bar, 
 	ie_reg, scon_reg, tcon_reg, clear_flag,
-	p0_in, p1_in, p2_in, p3_in);
+	p0_in, p1_in, p2_in, p3_in,
+	dptr_inc, dptr_ld, dptr_di, dptr,
+	sp_ld, sp_di, sp_reg, acc_reg, psw_reg,
+	div_wb, div_ov, quotient_o(7 downto 0), remainder_o(7 downto 0));
 	
 MUL:multiplier
 	port map(clk_div, mul_a_i, mul_b_i, mul_prod_o);
 
 ROM:int_rom
+	generic map(12, ROM_IMAGE)
 	port map(clk_div, rst_bar, i_rom_rd , i_rom_addr, i_rom_data);
 
 RAM:internal_ram
 	port map(clk_div, rst_bar, 
 	i_ram_wrByte, i_ram_wrBit, i_ram_rdByte, i_ram_rdBit,
-	i_ram_addr, 
-	i_ram_diByte, i_ram_diBit, i_ram_doByte, i_ram_doBit);
+	i_ram_addr, i_ram_ind, 
+	i_ram_diByte, i_ram_diBit, i_ram_bitOp, ram_doByte, ram_doBit,
+	i_ram_pair, i_ram_diHi, i_ram_doHi, ram_busy);
 	
 DIV:divider
-	port map(clk_div, rst_bar, 
-	dividend_i, divisor_i, quotient_o, remainder_o, div_done);
+	port map(clk_div, rst_bar, div_start,
+	dividend_i, divisor_i, quotient_o, remainder_o, open, div_done);
 
 INTERRUPT:int_handler
-	port map(clk_div, rst_bar, ie_reg, scon_reg, tcon_reg, i_flag);
+	port map(clk_div, rst_bar, ie_reg, scon_reg, tcon_reg, mdu_irq, i_flag);
+
+PERF:perf_counter
+	port map(rst_bar, clk_div,
+	i_ram_addr, i_ram_ind, i_ram_wrByte, i_ram_rdByte, i_ram_diByte, pm_doByte,
+	instr_retire, div_wait, ram_access, illegal_op, pred_hit, pred_miss);
+
+RDMUX:read_mux
+	port map(clk_div, i_ram_addr, i_ram_ind,
+	ram_doByte, ram_doBit, sfr_doByte, sfr_doBit, pm_doByte, mdu_doByte,
+	i_ram_doByte, i_ram_doBit);
+
+MDU1:mdu
+	port map(rst_bar, clk_div,
+	i_ram_addr, i_ram_ind, i_ram_wrByte, i_ram_diByte, mdu_doByte, mdu_irq);
+
+	pc_debug <= pc_cur;
+
+TRACE:trace_port
+	port map(clk_div, rst_bar, trace_mode,
+	instr_retire, trace_pc, trace_ir, trace_taken, pc_cur,
+	acc_reg, psw_reg, sp_reg,
+	i_ram_wrByte, i_ram_addr, i_ram_ind, i_ram_pair, i_ram_diByte, i_ram_diHi,
+	trace_rd, trace_data, trace_valid, trace_ovf, trace_state, trace_wr);
 
 
 
@@ -0,0 +1,44 @@
+library IEEE;
+use IEEE.std_logic_1164.all;
+use IEEE.std_logic_arith.all;
+use IEEE.std_logic_unsigned.all;
+use work.constants.all;
+
+-- Bit manipulation unit shared by internal_ram and regfile. Given the byte
+-- holding the addressed bit it returns the old bit value and the byte with
+-- the operation applied, so a bit read-modify-write completes in one clock.
+-- JBC is a BIT_OPC_CLR whose old bit is tested by the sequencer.
+
+entity bit_unit is
+port (
+	op		:	in std_logic_vector(2 downto 0);
+	sel		:	in std_logic_vector(2 downto 0);	-- bit position
+	diBit		:	in std_logic;				-- used by BIT_OPC_MOV
+	byte_in	:	in std_logic_vector(7 downto 0);
+	byte_out	:	out std_logic_vector(7 downto 0);
+	bit_out	:	out std_logic				-- bit before the operation
+);
+end bit_unit;
+
+architecture rtl of bit_unit is
+begin
+
+	process (op, sel, diBit, byte_in)
+		variable L	:	INTEGER;
+		variable v	:	std_logic_vector(7 downto 0);
+	begin
+		L := conv_integer(sel);
+		v := byte_in;
+
+		case op is
+			when BIT_OPC_SET => v(L) := '1';
+			when BIT_OPC_CLR => v(L) := '0';
+			when BIT_OPC_CPL => v(L) := not byte_in(L);
+			when others	 => v(L) := diBit;
+		end case;
+
+		bit_out <= byte_in(L);
+		byte_out <= v;
+	end process;
+
+end rtl;
@@ -6,19 +6,52 @@ use ieee.std_logic_arith.all;
 -- to aid in easy comprehensibility of the code.
 
 package constants is
-    constant ALU_OPC_NONE   : std_logic_vector (3 downto 0) := "0000";
-    constant ALU_OPC_ADD    : std_logic_vector (3 downto 0) := "0001";
-    constant ALU_OPC_SUB    : std_logic_vector (3 downto 0) := "0010";
-    constant ALU_OPC_DEC    : std_logic_vector (3 downto 0) := "0011";
-    constant ALU_OPC_ADC    : std_logic_vector (3 downto 0) := "0100";
-    constant ALU_OPC_INC    : std_logic_vector (3 downto 0) := "0101";
-    constant ALU_OPC_NOT    : std_logic_vector (3 downto 0) := "0110";
-    constant ALU_OPC_AND    : std_logic_vector (3 downto 0) := "0111";
-    constant ALU_OPC_XOR    : std_logic_vector (3 downto 0) := "1000";
-    constant ALU_OPC_OR     : std_logic_vector (3 downto 0) := "1001";
-    constant ALU_OPC_NEG    : std_logic_vector (3 downto 0) := "1010";
-    constant ALU_OPC_SBB    : std_logic_vector (3 downto 0) := "1011";
- 
+    constant ALU_OPC_NONE   : std_logic_vector (4 downto 0) := "00000";
+    constant ALU_OPC_ADD    : std_logic_vector (4 downto 0) := "00001";
+    constant ALU_OPC_SUB    : std_logic_vector (4 downto 0) := "00010";
+    constant ALU_OPC_DEC    : std_logic_vector (4 downto 0) := "00011";
+    constant ALU_OPC_ADC    : std_logic_vector (4 downto 0) := "00100";
+    constant ALU_OPC_INC    : std_logic_vector (4 downto 0) := "00101";
+    constant ALU_OPC_NOT    : std_logic_vector (4 downto 0) := "00110";
+    constant ALU_OPC_AND    : std_logic_vector (4 downto 0) := "00111";
+    constant ALU_OPC_XOR    : std_logic_vector (4 downto 0) := "01000";
+    constant ALU_OPC_OR     : std_logic_vector (4 downto 0) := "01001";
+    constant ALU_OPC_NEG    : std_logic_vector (4 downto 0) := "01010";
+    constant ALU_OPC_SBB    : std_logic_vector (4 downto 0) := "01011";
+    constant ALU_OPC_RL     : std_logic_vector (4 downto 0) := "01100";
+    constant ALU_OPC_RR     : std_logic_vector (4 downto 0) := "01101";
+    constant ALU_OPC_RLC    : std_logic_vector (4 downto 0) := "01110"; -- through cy_bw, CY out
+    constant ALU_OPC_RRC    : std_logic_vector (4 downto 0) := "01111";
+    constant ALU_OPC_SWAP   : std_logic_vector (4 downto 0) := "10000"; -- exchange nibbles
+    constant ALU_OPC_DA     : std_logic_vector (4 downto 0) := "10001"; -- decimal adjust, uses cy_bw and ac_in
+
+    -- PSW flags written by a table driven instruction (decode_rom)
+    constant FL_NONE        : std_logic_vector (1 downto 0) := "00";
+    constant FL_CY          : std_logic_vector (1 downto 0) := "01"; -- CY only
+    constant FL_ALL         : std_logic_vector (1 downto 0) := "10"; -- CY, AC and OV
+
+    -- bit read-modify-write operations (i_ram_bitOp)
+    constant BIT_OPC_MOV    : std_logic_vector (2 downto 0) := "000";
+    constant BIT_OPC_SET    : std_logic_vector (2 downto 0) := "001";
+    constant BIT_OPC_CLR    : std_logic_vector (2 downto 0) := "010";
+    constant BIT_OPC_CPL    : std_logic_vector (2 downto 0) := "011";
+
+    -- instruction classes (decode_rom)
+    constant CLS_SEQ        : std_logic_vector (3 downto 0) := "0000"; -- own sequence in sequencer2
+    constant CLS_NOP        : std_logic_vector (3 downto 0) := "0001";
+    constant CLS_MOV        : std_logic_vector (3 downto 0) := "0010"; -- dst <= src
+    constant CLS_ALU        : std_logic_vector (3 downto 0) := "0011"; -- dst <= dst op src
+    constant CLS_UNARY      : std_logic_vector (3 downto 0) := "0100"; -- src <= op src
+    constant CLS_UNDEF      : std_logic_vector (3 downto 0) := "1111";
+
+    -- operand addressing modes (decode_rom)
+    constant AM_NONE        : std_logic_vector (2 downto 0) := "000";
+    constant AM_ACC         : std_logic_vector (2 downto 0) := "001";
+    constant AM_RN          : std_logic_vector (2 downto 0) := "010";
+    constant AM_DIR         : std_logic_vector (2 downto 0) := "011";
+    constant AM_IND         : std_logic_vector (2 downto 0) := "100"; -- @Ri
+    constant AM_IMM         : std_logic_vector (2 downto 0) := "101";
+
     constant xE0  : std_logic_vector (7 downto 0) := "11100000";
     constant xF0    : std_logic_vector (7 downto 0) := "11110000";
     constant x83  : std_logic_vector (7 downto 0) := "10000011";
@@ -40,7 +73,24 @@ package constants is
     constant x8A  : std_logic_vector (7 downto 0) := "10001010";
     constant x8B  : std_logic_vector (7 downto 0) := "10001011";
     constant x89 : std_logic_vector (7 downto 0) := "10001001";
-    		   
+    constant x84  : std_logic_vector (7 downto 0) := "10000100"; -- DPL1
+    constant x85  : std_logic_vector (7 downto 0) := "10000101"; -- DPH1
+    constant x86  : std_logic_vector (7 downto 0) := "10000110"; -- DPS
+    constant xD7  : std_logic_vector (7 downto 0) := "11010111"; -- CY bit
+    constant xE9  : std_logic_vector (7 downto 0) := "11101001"; -- MD0
+    constant xEA  : std_logic_vector (7 downto 0) := "11101010"; -- MD1
+    constant xEB  : std_logic_vector (7 downto 0) := "11101011"; -- MD2
+    constant xEC  : std_logic_vector (7 downto 0) := "11101100"; -- MD3
+    constant xED  : std_logic_vector (7 downto 0) := "11101101"; -- MD4
+    constant xEE  : std_logic_vector (7 downto 0) := "11101110"; -- MD5
+    constant xEF  : std_logic_vector (7 downto 0) := "11101111"; -- MDCON
+    constant xF9  : std_logic_vector (7 downto 0) := "11111001"; -- PMCON
+    constant xFA  : std_logic_vector (7 downto 0) := "11111010"; -- PMSEL
+    constant xFB  : std_logic_vector (7 downto 0) := "11111011"; -- PMD0
+    constant xFC  : std_logic_vector (7 downto 0) := "11111100"; -- PMD1
+    constant xFD  : std_logic_vector (7 downto 0) := "11111101"; -- PMD2
+    constant xFE  : std_logic_vector (7 downto 0) := "11111110"; -- PMD3
+
     constant BYTE	    : std_logic := '0';
     constant WORD	    : std_logic := '1';
          
@@ -0,0 +1,351 @@
+library IEEE;
+use IEEE.std_logic_1164.all;
+use IEEE.std_logic_arith.all;
+use IEEE.std_logic_unsigned.all;
+use work.constants.all;
+
+-- Opcode decode table. The word for the opcode on i_rom_data is registered
+-- when IR is loaded, so the sequencer starts execute with the class, the
+-- operand modes and the ALU operation already decoded. The registered read
+-- lets the table go into a block RAM.
+--
+-- 16-13	class (CLS_*)
+-- 12-10	source operand (AM_*)
+-- 9-7		destination operand (AM_*)
+-- 6-2		ALU operation
+-- 1-0		PSW flags written (FL_*)
+--
+-- CLS_SEQ opcodes still have their own sequence in sequencer2, CLS_UNDEF
+-- marks the opcodes the core does not implement.
+--
+-- CLS_SEQ, hand-written sequences:
+--	AJMP/ACALL (x1), LJMP 02, LCALL 12, RET 22, RETI 32, JBC 10,
+--	JZ 60, JNZ 70, SJMP 80, JMP @A+DPTR 73, CJNE B4-BF, DJNZ D5 D8-DF,
+--	MOV bit,C 92, MOV C,bit A2, CLR/SETB/CPL bit and C (B2 B3 C2 C3
+--	D2 D3), CLR A E4, DIV AB 84, MOV DPTR,#data16 90, INC DPTR A3,
+--	the A5 prefix
+--
+-- CLS_UNDEF, not implemented, pulse illegal_op and run as a one byte NOP:
+--	JB 20, JNB 30, JC 40, JNC 50, ORL C,bit 72, ANL C,bit 82,
+--	ORL C,/bit A0, ANL C,/bit B0, MOVC 83 93, MUL AB A4, PUSH C0,
+--	POP D0, XCH C5-CF, XCHD D6 D7, MOVX E0 E2 E3 F0 F2 F3
+
+entity decode_rom is
+port (
+	clk		:	in std_logic;
+	rd		:	in std_logic;
+	opcode	:	in std_logic_vector(7 downto 0);
+	dec_class	:	out std_logic_vector(3 downto 0);
+	dec_src	:	out std_logic_vector(2 downto 0);
+	dec_dst	:	out std_logic_vector(2 downto 0);
+	dec_alu	:	out std_logic_vector(4 downto 0);
+	dec_flags	:	out std_logic_vector(1 downto 0)
+);
+end decode_rom;
+
+architecture rtl of decode_rom is
+
+	constant NF		: std_logic_vector(1 downto 0) := FL_NONE;
+	constant CF		: std_logic_vector(1 downto 0) := FL_CY;
+	constant WF		: std_logic_vector(1 downto 0) := FL_ALL;
+
+	constant D_SEQ	: std_logic_vector(16 downto 0) := CLS_SEQ & AM_NONE & AM_NONE & ALU_OPC_NONE & NF;
+	constant D_NOP	: std_logic_vector(16 downto 0) := CLS_NOP & AM_NONE & AM_NONE & ALU_OPC_NONE & NF;
+	constant D_UNDEF	: std_logic_vector(16 downto 0) := CLS_UNDEF & AM_NONE & AM_NONE & ALU_OPC_NONE & NF;
+
+	type rom_type is array (0 to 255) of std_logic_vector(16 downto 0);
+	constant DECODE : rom_type := (
+		-- 0x
+		D_NOP,	-- 00 NOP
+		D_SEQ,	-- 01 AJMP addr11
+		D_SEQ,	-- 02 LJMP addr16
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_RR   & NF,	-- 03 RR A
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_INC  & NF,	-- 04 INC A
+		CLS_UNARY & AM_DIR  & AM_NONE & ALU_OPC_INC  & NF,	-- 05 INC direct
+		CLS_UNARY & AM_IND  & AM_NONE & ALU_OPC_INC  & NF,	-- 06 INC @R0
+		CLS_UNARY & AM_IND  & AM_NONE & ALU_OPC_INC  & NF,	-- 07 INC @R1
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 08 INC R0
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 09 INC R1
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 0A INC R2
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 0B INC R3
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 0C INC R4
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 0D INC R5
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 0E INC R6
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_INC  & NF,	-- 0F INC R7
+		-- 1x
+		D_SEQ,	-- 10 JBC bit,rel
+		D_SEQ,	-- 11 ACALL addr11
+		D_SEQ,	-- 12 LCALL addr16
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_RRC  & CF,	-- 13 RRC A
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_DEC  & NF,	-- 14 DEC A
+		CLS_UNARY & AM_DIR  & AM_NONE & ALU_OPC_DEC  & NF,	-- 15 DEC direct
+		CLS_UNARY & AM_IND  & AM_NONE & ALU_OPC_DEC  & NF,	-- 16 DEC @R0
+		CLS_UNARY & AM_IND  & AM_NONE & ALU_OPC_DEC  & NF,	-- 17 DEC @R1
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 18 DEC R0
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 19 DEC R1
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 1A DEC R2
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 1B DEC R3
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 1C DEC R4
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 1D DEC R5
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 1E DEC R6
+		CLS_UNARY & AM_RN   & AM_NONE & ALU_OPC_DEC  & NF,	-- 1F DEC R7
+		-- 2x
+		D_UNDEF,	-- 20 JB bit,rel
+		D_SEQ,	-- 21 AJMP addr11
+		D_SEQ,	-- 22 RET
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_RL   & NF,	-- 23 RL A
+		CLS_ALU   & AM_IMM  & AM_ACC  & ALU_OPC_ADD  & WF,	-- 24 ADD A,#data
+		CLS_ALU   & AM_DIR  & AM_ACC  & ALU_OPC_ADD  & WF,	-- 25 ADD A,direct
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_ADD  & WF,	-- 26 ADD A,@R0
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_ADD  & WF,	-- 27 ADD A,@R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 28 ADD A,R0
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 29 ADD A,R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 2A ADD A,R2
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 2B ADD A,R3
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 2C ADD A,R4
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 2D ADD A,R5
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 2E ADD A,R6
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADD  & WF,	-- 2F ADD A,R7
+		-- 3x
+		D_UNDEF,	-- 30 JNB bit,rel
+		D_SEQ,	-- 31 ACALL addr11
+		D_SEQ,	-- 32 RETI
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_RLC  & CF,	-- 33 RLC A
+		CLS_ALU   & AM_IMM  & AM_ACC  & ALU_OPC_ADC  & WF,	-- 34 ADDC A,#data
+		CLS_ALU   & AM_DIR  & AM_ACC  & ALU_OPC_ADC  & WF,	-- 35 ADDC A,direct
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_ADC  & WF,	-- 36 ADDC A,@R0
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_ADC  & WF,	-- 37 ADDC A,@R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 38 ADDC A,R0
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 39 ADDC A,R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 3A ADDC A,R2
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 3B ADDC A,R3
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 3C ADDC A,R4
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 3D ADDC A,R5
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 3E ADDC A,R6
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_ADC  & WF,	-- 3F ADDC A,R7
+		-- 4x
+		D_UNDEF,	-- 40 JC rel
+		D_SEQ,	-- 41 AJMP addr11
+		CLS_ALU   & AM_ACC  & AM_DIR  & ALU_OPC_OR   & NF,	-- 42 ORL direct,A
+		CLS_ALU   & AM_IMM  & AM_DIR  & ALU_OPC_OR   & NF,	-- 43 ORL direct,#data
+		CLS_ALU   & AM_IMM  & AM_ACC  & ALU_OPC_OR   & NF,	-- 44 ORL A,#data
+		CLS_ALU   & AM_DIR  & AM_ACC  & ALU_OPC_OR   & NF,	-- 45 ORL A,direct
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_OR   & NF,	-- 46 ORL A,@R0
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_OR   & NF,	-- 47 ORL A,@R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 48 ORL A,R0
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 49 ORL A,R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 4A ORL A,R2
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 4B ORL A,R3
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 4C ORL A,R4
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 4D ORL A,R5
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 4E ORL A,R6
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_OR   & NF,	-- 4F ORL A,R7
+		-- 5x
+		D_UNDEF,	-- 50 JNC rel
+		D_SEQ,	-- 51 ACALL addr11
+		CLS_ALU   & AM_ACC  & AM_DIR  & ALU_OPC_AND  & NF,	-- 52 ANL direct,A
+		CLS_ALU   & AM_IMM  & AM_DIR  & ALU_OPC_AND  & NF,	-- 53 ANL direct,#data
+		CLS_ALU   & AM_IMM  & AM_ACC  & ALU_OPC_AND  & NF,	-- 54 ANL A,#data
+		CLS_ALU   & AM_DIR  & AM_ACC  & ALU_OPC_AND  & NF,	-- 55 ANL A,direct
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_AND  & NF,	-- 56 ANL A,@R0
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_AND  & NF,	-- 57 ANL A,@R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 58 ANL A,R0
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 59 ANL A,R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 5A ANL A,R2
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 5B ANL A,R3
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 5C ANL A,R4
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 5D ANL A,R5
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 5E ANL A,R6
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_AND  & NF,	-- 5F ANL A,R7
+		-- 6x
+		D_SEQ,	-- 60 JZ rel
+		D_SEQ,	-- 61 AJMP addr11
+		CLS_ALU   & AM_ACC  & AM_DIR  & ALU_OPC_XOR  & NF,	-- 62 XRL direct,A
+		CLS_ALU   & AM_IMM  & AM_DIR  & ALU_OPC_XOR  & NF,	-- 63 XRL direct,#data
+		CLS_ALU   & AM_IMM  & AM_ACC  & ALU_OPC_XOR  & NF,	-- 64 XRL A,#data
+		CLS_ALU   & AM_DIR  & AM_ACC  & ALU_OPC_XOR  & NF,	-- 65 XRL A,direct
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_XOR  & NF,	-- 66 XRL A,@R0
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_XOR  & NF,	-- 67 XRL A,@R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 68 XRL A,R0
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 69 XRL A,R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 6A XRL A,R2
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 6B XRL A,R3
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 6C XRL A,R4
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 6D XRL A,R5
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 6E XRL A,R6
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_XOR  & NF,	-- 6F XRL A,R7
+		-- 7x
+		D_SEQ,	-- 70 JNZ rel
+		D_SEQ,	-- 71 ACALL addr11
+		D_UNDEF,	-- 72 ORL C,bit
+		D_SEQ,	-- 73 JMP @A+DPTR
+		CLS_MOV   & AM_IMM  & AM_ACC  & ALU_OPC_NONE & NF,	-- 74 MOV A,#data
+		CLS_MOV   & AM_IMM  & AM_DIR  & ALU_OPC_NONE & NF,	-- 75 MOV direct,#data
+		CLS_MOV   & AM_IMM  & AM_IND  & ALU_OPC_NONE & NF,	-- 76 MOV @R0,#data
+		CLS_MOV   & AM_IMM  & AM_IND  & ALU_OPC_NONE & NF,	-- 77 MOV @R1,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 78 MOV R0,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 79 MOV R1,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 7A MOV R2,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 7B MOV R3,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 7C MOV R4,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 7D MOV R5,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 7E MOV R6,#data
+		CLS_MOV   & AM_IMM  & AM_RN   & ALU_OPC_NONE & NF,	-- 7F MOV R7,#data
+		-- 8x
+		D_SEQ,	-- 80 SJMP rel
+		D_SEQ,	-- 81 AJMP addr11
+		D_UNDEF,	-- 82 ANL C,bit
+		D_UNDEF,	-- 83 MOVC A,@A+PC
+		D_SEQ,	-- 84 DIV AB
+		CLS_MOV   & AM_DIR  & AM_DIR  & ALU_OPC_NONE & NF,	-- 85 MOV direct,direct
+		CLS_MOV   & AM_IND  & AM_DIR  & ALU_OPC_NONE & NF,	-- 86 MOV direct,@R0
+		CLS_MOV   & AM_IND  & AM_DIR  & ALU_OPC_NONE & NF,	-- 87 MOV direct,@R1
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 88 MOV direct,R0
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 89 MOV direct,R1
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 8A MOV direct,R2
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 8B MOV direct,R3
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 8C MOV direct,R4
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 8D MOV direct,R5
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 8E MOV direct,R6
+		CLS_MOV   & AM_RN   & AM_DIR  & ALU_OPC_NONE & NF,	-- 8F MOV direct,R7
+		-- 9x
+		D_SEQ,	-- 90 MOV DPTR,#data16
+		D_SEQ,	-- 91 ACALL addr11
+		D_SEQ,	-- 92 MOV bit,C
+		D_UNDEF,	-- 93 MOVC A,@A+DPTR
+		CLS_ALU   & AM_IMM  & AM_ACC  & ALU_OPC_SBB  & WF,	-- 94 SUBB A,#data
+		CLS_ALU   & AM_DIR  & AM_ACC  & ALU_OPC_SBB  & WF,	-- 95 SUBB A,direct
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_SBB  & WF,	-- 96 SUBB A,@R0
+		CLS_ALU   & AM_IND  & AM_ACC  & ALU_OPC_SBB  & WF,	-- 97 SUBB A,@R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 98 SUBB A,R0
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 99 SUBB A,R1
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 9A SUBB A,R2
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 9B SUBB A,R3
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 9C SUBB A,R4
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 9D SUBB A,R5
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 9E SUBB A,R6
+		CLS_ALU   & AM_RN   & AM_ACC  & ALU_OPC_SBB  & WF,	-- 9F SUBB A,R7
+		-- Ax
+		D_UNDEF,	-- A0 ORL C,/bit
+		D_SEQ,	-- A1 AJMP addr11
+		D_SEQ,	-- A2 MOV C,bit
+		D_SEQ,	-- A3 INC DPTR
+		D_UNDEF,	-- A4 MUL AB
+		D_SEQ,	-- A5 16 bit operations (prefix)
+		CLS_MOV   & AM_DIR  & AM_IND  & ALU_OPC_NONE & NF,	-- A6 MOV @R0,direct
+		CLS_MOV   & AM_DIR  & AM_IND  & ALU_OPC_NONE & NF,	-- A7 MOV @R1,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- A8 MOV R0,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- A9 MOV R1,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- AA MOV R2,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- AB MOV R3,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- AC MOV R4,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- AD MOV R5,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- AE MOV R6,direct
+		CLS_MOV   & AM_DIR  & AM_RN   & ALU_OPC_NONE & NF,	-- AF MOV R7,direct
+		-- Bx
+		D_UNDEF,	-- B0 ANL C,/bit
+		D_SEQ,	-- B1 ACALL addr11
+		D_SEQ,	-- B2 CPL bit
+		D_SEQ,	-- B3 CPL C
+		D_SEQ,	-- B4 CJNE A,#data,rel
+		D_SEQ,	-- B5 CJNE A,direct,rel
+		D_SEQ,	-- B6 CJNE @R0,#data,rel
+		D_SEQ,	-- B7 CJNE @R1,#data,rel
+		D_SEQ,	-- B8 CJNE R0,#data,rel
+		D_SEQ,	-- B9 CJNE R1,#data,rel
+		D_SEQ,	-- BA CJNE R2,#data,rel
+		D_SEQ,	-- BB CJNE R3,#data,rel
+		D_SEQ,	-- BC CJNE R4,#data,rel
+		D_SEQ,	-- BD CJNE R5,#data,rel
+		D_SEQ,	-- BE CJNE R6,#data,rel
+		D_SEQ,	-- BF CJNE R7,#data,rel
+		-- Cx
+		D_UNDEF,	-- C0 PUSH direct
+		D_SEQ,	-- C1 AJMP addr11
+		D_SEQ,	-- C2 CLR bit
+		D_SEQ,	-- C3 CLR C
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_SWAP & NF,	-- C4 SWAP A
+		D_UNDEF,	-- C5 XCH A,direct
+		D_UNDEF,	-- C6 XCH A,@R0
+		D_UNDEF,	-- C7 XCH A,@R1
+		D_UNDEF,	-- C8 XCH A,R0
+		D_UNDEF,	-- C9 XCH A,R1
+		D_UNDEF,	-- CA XCH A,R2
+		D_UNDEF,	-- CB XCH A,R3
+		D_UNDEF,	-- CC XCH A,R4
+		D_UNDEF,	-- CD XCH A,R5
+		D_UNDEF,	-- CE XCH A,R6
+		D_UNDEF,	-- CF XCH A,R7
+		-- Dx
+		D_UNDEF,	-- D0 POP direct
+		D_SEQ,	-- D1 ACALL addr11
+		D_SEQ,	-- D2 SETB bit
+		D_SEQ,	-- D3 SETB C
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_DA   & CF,	-- D4 DA A
+		D_SEQ,	-- D5 DJNZ direct,rel
+		D_UNDEF,	-- D6 XCHD A,@R0
+		D_UNDEF,	-- D7 XCHD A,@R1
+		D_SEQ,	-- D8 DJNZ R0,rel
+		D_SEQ,	-- D9 DJNZ R1,rel
+		D_SEQ,	-- DA DJNZ R2,rel
+		D_SEQ,	-- DB DJNZ R3,rel
+		D_SEQ,	-- DC DJNZ R4,rel
+		D_SEQ,	-- DD DJNZ R5,rel
+		D_SEQ,	-- DE DJNZ R6,rel
+		D_SEQ,	-- DF DJNZ R7,rel
+		-- Ex
+		D_UNDEF,	-- E0 MOVX A,@DPTR
+		D_SEQ,	-- E1 AJMP addr11
+		D_UNDEF,	-- E2 MOVX A,@R0
+		D_UNDEF,	-- E3 MOVX A,@R1
+		D_SEQ,	-- E4 CLR A
+		CLS_MOV   & AM_DIR  & AM_ACC  & ALU_OPC_NONE & NF,	-- E5 MOV A,direct
+		CLS_MOV   & AM_IND  & AM_ACC  & ALU_OPC_NONE & NF,	-- E6 MOV A,@R0
+		CLS_MOV   & AM_IND  & AM_ACC  & ALU_OPC_NONE & NF,	-- E7 MOV A,@R1
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- E8 MOV A,R0
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- E9 MOV A,R1
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- EA MOV A,R2
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- EB MOV A,R3
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- EC MOV A,R4
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- ED MOV A,R5
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- EE MOV A,R6
+		CLS_MOV   & AM_RN   & AM_ACC  & ALU_OPC_NONE & NF,	-- EF MOV A,R7
+		-- Fx
+		D_UNDEF,	-- F0 MOVX @DPTR,A
+		D_SEQ,	-- F1 ACALL addr11
+		D_UNDEF,	-- F2 MOVX @R0,A
+		D_UNDEF,	-- F3 MOVX @R1,A
+		CLS_UNARY & AM_ACC  & AM_NONE & ALU_OPC_NOT  & NF,	-- F4 CPL A
+		CLS_MOV   & AM_ACC  & AM_DIR  & ALU_OPC_NONE & NF,	-- F5 MOV direct,A
+		CLS_MOV   & AM_ACC  & AM_IND  & ALU_OPC_NONE & NF,	-- F6 MOV @R0,A
+		CLS_MOV   & AM_ACC  & AM_IND  & ALU_OPC_NONE & NF,	-- F7 MOV @R1,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF,	-- F8 MOV R0,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF,	-- F9 MOV R1,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF,	-- FA MOV R2,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF,	-- FB MOV R3,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF,	-- FC MOV R4,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF,	-- FD MOV R5,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF,	-- FE MOV R6,A
+		CLS_MOV   & AM_ACC  & AM_RN   & ALU_OPC_NONE & NF 	-- FF MOV R7,A
+	);
+
+	signal dec_word		: std_logic_vector(16 downto 0);
+
+begin
+
+	process (clk)
+	begin
+		if (clk'event and clk = '1') then
+			if (rd = '1') then
+				dec_word <= DECODE(conv_integer(opcode));
+			end if;
+		end if;
+	end process;
+
+	dec_class <= dec_word(16 downto 13);
+	dec_src <= dec_word(12 downto 10);
+	dec_dst <= dec_word(9 downto 7);
+	dec_alu <= dec_word(6 downto 2);
+	dec_flags <= dec_word(1 downto 0);
+
+end rtl;
@@ -20,12 +20,13 @@
 library ieee;
 use ieee.std_logic_1164.all;
 use ieee.std_logic_arith.all;
+use ieee.std_logic_unsigned.all;
 use work.constants.all;
 
 -- 8/16 bit Arithmetic and Logic Unit - top level entity.
 
 entity fastalu is port (
-	op_code	: in  std_logic_vector (3 downto 0);
+	op_code	: in  std_logic_vector (4 downto 0);
       -- What operation
 
 	src_1L	: in  std_logic_vector (7 downto 0);
@@ -36,6 +37,7 @@ entity fastalu is port (
 	
 	by_wd	: in  std_logic;             -- byte(0)/word(1) instruction
 	cy_bw	: in  std_logic;             -- carry/borrow bit
+	ac_in	: in  std_logic;             -- auxiliary carry, used by DA
 	
 	ans_L	: out std_logic_vector (7 downto 0);
 	ans_H	: out std_logic_vector (7 downto 0);
@@ -64,6 +66,8 @@ signal AI, BI, SI : std_logic_vector(15 downto 0);
 signal ci : std_logic;
 signal int_c4, int_c7, int_c8, int_c15, int_c16 : std_logic;
 signal sub	: std_logic;
+signal fsel	: std_logic;	-- carry comes from fcy, not from the adder
+signal fcy	: std_logic;
 begin
 
 adder_comp :		csadder  
@@ -80,7 +84,9 @@ adder_comp :		csadder
 							carry16 => int_c16
 						);
 
-process(op_code, src_1L, src_2L, src_1H, src_2H, cy_bw, by_wd, SI,int_c4, int_c7, int_c8, int_c15, int_c16)
+process(op_code, src_1L, src_2L, src_1H, src_2H, cy_bw, ac_in, by_wd, SI,int_c4, int_c7, int_c8, int_c15, int_c16)
+   variable d	:	std_logic_vector(8 downto 0);
+   variable dc	:	std_logic;
 begin
 
 	AI <= (others => '0');
@@ -89,6 +95,8 @@ begin
 	ans_L <= (others => '0');
 	ci <= '0';
 	sub <= '0';
+	fsel <= '0';
+	fcy <= '0';
 
 	--alu_ac <= int_ac;
 	--alu_ov <= int_ov;
@@ -185,17 +193,19 @@ begin
 		sub <= '0';
 
 	-- logic operations
---	when ALU_OPC_NOT =>
---		ans_L		<= not src_1L;
---		
---		if (by_wd = '1') then
---			ans_H		<= not src_1H;
---		else
---			ans_H		<= (others => '0');
---		end if;
---
+	when ALU_OPC_NOT =>
+		ans_L		<= not src_1L;
+		
+		if (by_wd = '1') then
+			ans_H		<= not src_1H;
+		else
+			ans_H		<= (others => '0');
+		end if;
+
 	when ALU_OPC_AND =>
 		ans_L		<= src_1L and src_2L;
+		fcy		<= cy_bw;	-- CY passes through unchanged
+		fsel		<= '1';
 		
 		if (by_wd = '1') then
 			ans_H		<= src_1H and src_2H;
@@ -205,6 +215,8 @@ begin
 
 	when ALU_OPC_XOR =>
 		ans_L		<= src_1L xor src_2L;
+		fcy		<= cy_bw;	-- CY passes through unchanged
+		fsel		<= '1';
 		
 		if (by_wd = '1') then
 			ans_H		<= src_1H xor src_2H;
@@ -214,6 +226,8 @@ begin
 
 	when ALU_OPC_OR =>
 		ans_L		<= src_1L or src_2L;
+		fcy		<= cy_bw;	-- CY passes through unchanged
+		fsel		<= '1';
 		
 		if (by_wd = '1') then
 			ans_H		<= src_1H or src_2H;
@@ -221,19 +235,53 @@ begin
 			ans_H		<= (others => '0');
 		end if;
 
---	when ALU_OPC_NEG =>
---		AI	<= (others => '0');
---		BI	<= not(src_1H) & not(src_1L);
---		ans_H <= SI(15 downto 8);
---		ans_L <= SI(7 downto 0);
---		
---		if (by_wd = '0') then
---			AI(15 downto 8)	<= (others => '0');
---			BI(15 downto 8)	<= (others => '0');
---			ans_H <= (others => '0');
---		end if;
---		
---		ci <= '1';
+	when ALU_OPC_NEG => -- 0 - src_1, flags as for a subtract
+		AI	<= (others => '0');
+		BI	<= not(src_1H) & not(src_1L);
+		ans_H <= SI(15 downto 8);
+		ans_L <= SI(7 downto 0);
+		
+		if (by_wd = '0') then
+			AI(15 downto 8)	<= (others => '0');
+			BI(15 downto 8)	<= (others => '0');
+			ans_H <= (others => '0');
+		end if;
+		
+		ci <= '1';
+		sub <= '1';
+
+	-- byte only operations on src_1L, ans_H is 0
+	when ALU_OPC_RL =>
+		ans_L		<= src_1L(6 downto 0) & src_1L(7);
+
+	when ALU_OPC_RR =>
+		ans_L		<= src_1L(0) & src_1L(7 downto 1);
+
+	when ALU_OPC_RLC => -- rotate through the carry
+		ans_L		<= src_1L(6 downto 0) & cy_bw;
+		fcy		<= src_1L(7);
+		fsel		<= '1';
+
+	when ALU_OPC_RRC =>
+		ans_L		<= cy_bw & src_1L(7 downto 1);
+		fcy		<= src_1L(0);
+		fsel		<= '1';
+
+	when ALU_OPC_SWAP =>
+		ans_L		<= src_1L(3 downto 0) & src_1L(7 downto 4);
+
+	when ALU_OPC_DA => -- decimal adjust after ADD/ADDC, CY is set but never cleared
+		d := '0' & src_1L;
+		if (src_1L(3 downto 0) > "1001" or ac_in = '1') then
+			d := d + "000000110";
+		end if;
+		dc := d(8) or cy_bw;
+		if (d(7 downto 4) > "1001" or dc = '1') then
+			d := d + "001100000";
+		end if;
+		ans_L		<= d(7 downto 0);
+		fcy		<= dc or d(8);
+		fsel		<= '1';
 
 	when others =>
    end case;
@@ -242,7 +290,7 @@ begin
 end process;
 
    -- flag process
-process(by_wd, sub, SI)
+process(by_wd, sub, SI, fsel, fcy, int_c4, int_c7, int_c8, int_c15, int_c16)
    variable v	:	std_logic_vector(1 downto 0);
    begin
    v := by_wd & sub;
@@ -263,6 +311,12 @@ process(by_wd, sub, SI)
 					alu_ac <= int_c4;
 					alu_ov <= int_c8 xor int_c7;
 	   end case; 
+
+	   -- rotates through the carry and DA only produce CY, logic operations
+	   -- pass it through
+	   if (fsel = '1') then
+		alu_cy <= fcy;
+	   end if;
 end process	; -- end flag process
 
 end fastalu_arch;
\ No newline at end of file
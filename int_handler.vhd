@@ -14,6 +14,7 @@ entity int_handler is
            IE_reg : in std_logic_vector(7 downto 0);
            SCON_reg : in std_logic_vector(7 downto 0);
            TCON_reg : in std_logic_vector(7 downto 0);
+           mdu_irq : in std_logic;	-- MDCON.DONE, enabled by IE bit 6
            int_select : out std_logic_vector(2 downto 0));
 end int_handler;
 
@@ -21,7 +22,7 @@ architecture Behavioral of int_handler is
 
 begin
 
-	process (clk, rst, IE_reg, SCON_reg, TCON_reg)
+	process (clk, rst, IE_reg, SCON_reg, TCON_reg, mdu_irq)
 
 begin
 
@@ -48,6 +49,9 @@ elsif(clk'event and clk = '1') then
 	elsif(IE_reg(4) = '1' and (SCON_reg(1) = '1' or SCON_reg(0) = '1')) then
 		int_select <= "101";
 
+	elsif(IE_reg(6) = '1' and mdu_irq = '1') then
+		int_select <= "110";
+
 	else
 		int_select <= "000";
 
@@ -5,62 +5,175 @@ use ieee.std_logic_unsigned.all;
 use work.constants.all;
 
 entity internal_ram is 
+generic (CLEAR_ON_RESET : boolean := true);
 port (
 	clk : in std_logic;
 	rst : in std_logic; 
- 	wrByte   : in std_logic; 
+ 	wrByte   : in std_logic; 	-- write strobes are one clock pulses
  	wrBit   : in std_logic; 
 
  	rdByte   : in std_logic; 
  	rdBit   : in std_logic; 
 
  	addr : in std_logic_vector(7 downto 0); 
+ 	ind : in std_logic;	-- indirect (@Ri/stack) access, reaches the upper 128 bytes
 
  	diByte  : in std_logic_vector(7 downto 0); 
  	diBit   : in std_logic; 
+ 	bitOp   : in std_logic_vector(2 downto 0); 
 
  	doByte   : out std_logic_vector(7 downto 0); 
- 	doBit   : out std_logic); 
+ 	doBit   : out std_logic;
+
+	-- pair access (stack): an indirect byte access that also covers
+	-- addr + 1 through diHi/doHi in the same clock
+ 	pair    : in std_logic;
+ 	diHi    : in std_logic_vector(7 downto 0); 
+ 	doHi    : out std_logic_vector(7 downto 0); 
+ 	busy    : out std_logic);	-- clearing after reset, see below
 end internal_ram; 
  
 architecture syn of internal_ram is 
-type ram_type is array (127 downto 0) of std_logic_vector (7 downto 0); 
-signal RAM : ram_type; 
+type bank_type is array (127 downto 0) of std_logic_vector (7 downto 0); 
+signal RAM_EV : bank_type;	-- 00h-FFh even bytes, 80h-FFh indirect only (8052 IDATA)
+signal RAM_OD : bank_type;	-- odd bytes
+-- XST reports in its HDL synthesis section if it can not honour this
+attribute ram_style : string;
+attribute ram_style of RAM_EV : signal is "block";
+attribute ram_style of RAM_OD : signal is "block";
+signal addr_n : std_logic_vector(7 downto 0);	-- addr + 1
+signal ev_a : std_logic_vector(7 downto 0);	-- even and odd byte of the pair addr, addr_n
+signal od_a : std_logic_vector(7 downto 0);
+signal bit_a : std_logic_vector(7 downto 0);	-- byte 20h-2Fh holding the addressed bit
+signal bit_op : std_logic;	-- bit access to the RAM (bit address below 80h)
+signal ev_i : std_logic_vector(6 downto 0);	-- bank index
+signal od_i : std_logic_vector(6 downto 0);
+signal ev_we : std_logic;
+signal od_we : std_logic;
+signal ev_di : std_logic_vector(7 downto 0);
+signal od_di : std_logic_vector(7 downto 0);
+signal ev_do : std_logic_vector(7 downto 0);
+signal od_do : std_logic_vector(7 downto 0);
+signal byte_we : std_logic;	-- byte write to the RAM space, not an SFR
+signal bit_byte : std_logic_vector(7 downto 0);
+signal bit_new : std_logic_vector(7 downto 0);
+signal bit_old : std_logic;
+signal clr : std_logic;	-- clear engine running
+signal clr_i : std_logic_vector(6 downto 0);	-- bank index being cleared
+
+component bit_unit is
+port (
+	op		:	in std_logic_vector(2 downto 0);
+	sel		:	in std_logic_vector(2 downto 0);
+	diBit		:	in std_logic;
+	byte_in	:	in std_logic_vector(7 downto 0);
+	byte_out	:	out std_logic_vector(7 downto 0);
+	bit_out	:	out std_logic);
+end component;
  
 begin 
-process (clk, rst, rdByte, rdBit, addr) 
+
+-- The 256 bytes are split into an even and an odd bank so that the two
+-- bytes of a pair access, which always differ in addr(0), go to different
+-- banks. Each bank has no reset and a registered read so it maps to block
+-- RAM. It is read on the falling edge, so the data is on doByte by the next
+-- rising edge, and a bit read-modify-write still completes in one clock:
+-- the byte holding the bit is read on the falling edge and written back
+-- on the rising edge.
+addr_n <= addr + '1';
+ev_a <= addr when addr(0) = '0' else addr_n;
+od_a <= addr when addr(0) = '1' else addr_n;
+bit_a <= "0010" & addr(6 downto 3);
+bit_op <= '1' when ((rdBit = '1' or wrBit = '1') and addr(7) = '0') else '0';
+byte_we <= '1' when (wrByte = '1' and (addr(7) = '0' or ind = '1')) else '0';
+
+ev_i <= clr_i when clr = '1' else
+	bit_a(7 downto 1) when bit_op = '1' else
+	ev_a(7 downto 1);
+od_i <= clr_i when clr = '1' else
+	bit_a(7 downto 1) when bit_op = '1' else
+	od_a(7 downto 1);
+
+ev_di <= "00000000" when clr = '1' else
+	bit_new when bit_op = '1' else
+	diByte when addr(0) = '0' else
+	diHi;
+od_di <= "00000000" when clr = '1' else
+	bit_new when bit_op = '1' else
+	diByte when addr(0) = '1' else
+	diHi;
+
+ev_we <= '1' when (clr = '1'
+	or (byte_we = '1' and (addr(0) = '0' or pair = '1'))
+	or (wrBit = '1' and bit_op = '1' and bit_a(0) = '0')) else '0';
+od_we <= '1' when (clr = '1'
+	or (byte_we = '1' and (addr(0) = '1' or pair = '1'))
+	or (wrBit = '1' and bit_op = '1' and bit_a(0) = '1')) else '0';
+
+process (clk)
+	begin
+	if (clk'event and clk = '1') then
+		if (ev_we = '1') then
+			RAM_EV(conv_integer(ev_i)) <= ev_di;
+		end if;
+		if (od_we = '1') then
+			RAM_OD(conv_integer(od_i)) <= od_di;
+		end if;
+	end if;
+end process;
+
+process (clk)
+	begin
+	if (clk'event and clk = '0') then
+		ev_do <= RAM_EV(conv_integer(ev_i));
+		od_do <= RAM_OD(conv_integer(od_i));
+	end if;
+end process;
+
+doByte <= ev_do when addr(0) = '0' else od_do;
+doHi <= od_do when addr(0) = '0' else ev_do;
+
+bit_byte <= ev_do when bit_a(0) = '0' else od_do;
+
+BITU: bit_unit
+port map
+(
+	op => bitOp,
+	sel => addr(2 downto 0),
+	diBit => diBit,
+	byte_in => bit_byte,
+	byte_out => bit_new,
+	bit_out => bit_old
+);
+
+-- the old bit is returned for reads and for read-modify-write alike, so
+-- JBC can test it in the same clock that clears it
+doBit <= bit_old;
+
+-- Clear engine: a block RAM has no reset, so after reset both banks are
+-- zeroed one index per clock. busy holds the sequencer in reset meanwhile
+-- (128 clocks). With CLEAR_ON_RESET false the RAM keeps its contents over
+-- a reset and is only zero after configuration.
+process (clk, rst) 
 	begin 
 	if (rst = '1') then
-		for i in 0 to 127 loop
-			RAM(i) <= "00000000";
-		end loop;
-		doByte <= "ZZZZZZZZ";
-		doBit <= 'Z';
-
-	elsif (rdByte = '1') then
-		if (addr(7) = '0') then
-			doByte <= RAM(conv_integer(addr(6 downto 0)));
-		else
-			doByte <= "ZZZZZZZZ";
-		end if;
-		
-	elsif (rdBit = '1') then
-		if (addr(7) = '0') then
-			doBit <= RAM(conv_integer("0010"&addr(6 downto 3)))(conv_integer(addr(2 downto 0)));
+		if (CLEAR_ON_RESET) then
+			clr <= '1';
 		else
-			doBit <= 'Z';
+			clr <= '0';
 		end if;
+		clr_i <= (others => '0');
 
 	elsif (clk'event and clk = '1') then  
-		if (wrByte = '1' and addr(7) = '0') then
-			RAM(conv_integer(addr(6 downto 0))) <= diByte;
-		end if;
-		
-		if (wrBit = '1' and addr(7) = '0') then
-			RAM(conv_integer("0010"&addr(6 downto 3)))(conv_integer(addr(2 downto 0))) <= diBit;
+		if (clr = '1') then
+			clr_i <= clr_i + '1';
+			if (clr_i = "1111111") then
+				clr <= '0';
+			end if;
 		end if;
 	end if;
 end process; 
-end syn;
- 
 
+busy <= clr;
+
+end syn;
@@ -4,7 +4,29 @@ use IEEE.STD_LOGIC_ARITH.ALL;
 use IEEE.STD_LOGIC_UNSIGNED.ALL;
 
 
+-- Program memory. The read is registered on the falling edge so it maps to
+-- block RAM and the opcode is on data by the next rising edge, the same
+-- timing the sequencer had with the asynchronous ROM. ADDR_WIDTH sets the
+-- size, 2**ADDR_WIDTH bytes up to the full 64 KB of i_rom_addr. Higher
+-- address bits are ignored.
+-- rd is high for the one clock after the sequencer issues a fetch or an
+-- operand read; data keeps the last byte read while it is low.
+--
+-- IMAGE picks the program:
+--   0  the bring-up program below (default)
+--   1  loop benchmark: DJNZ R6 nested in DJNZ R7 (10 x 100), then a
+--      100 pass INC A loop closed by DJNZ 30h, then SJMP $ at 0010h
+--   2  port poller: reads P0..P3 with MOV A,direct (the pins) and branches
+--      on the values with JZ/JNZ/CJNE, back to the poll loop at 0000h.
+--      The deepest path needs P1 = FFh, P0 = AAh, P2 = 55h and P3 = 00h.
+--   3  call and branch walk for the lockstep bench: ACALL, LCALL and RET
+--      (nested), AJMP, LJMP, SJMP, JZ, JNZ, DJNZ Rn/direct, CJNE A/Rn, with
+--      ADD/ADDC/SUBB/CPL/INC/DEC on ACC and MOV SP in between. It runs
+--      from 0000h again after the LJMP at 003Dh.
+
 entity int_rom is
+generic (ADDR_WIDTH : integer := 12;
+	 IMAGE      : integer := 0);
 port(
 		clk      : in  std_logic;
 		rst      : in  std_logic;
@@ -15,7 +37,7 @@ port(
 end int_rom;
 
 architecture Behavioral of int_rom is
-	type rom_type is array (0 to 4095) of STD_LOGIC_VECTOR (7 downto 0);
+	type rom_type is array (0 to 2**ADDR_WIDTH - 1) of STD_LOGIC_VECTOR (7 downto 0);
 	constant PROGRAM : ROM_TYPE := (
    "11100100",-- clrA
 	"01110100",--MOV A,data
@@ -33,16 +55,173 @@ architecture Behavioral of int_rom is
 	others => "00000000"
 );
 
+	constant LOOP_BENCH : ROM_TYPE := (
+		"01111111",	-- 000: MOV R7,#10
+		"00001010",
+		"01111110",	-- 002: outer: MOV R6,#100
+		"01100100",
+		"11011110",	-- 004: inner: DJNZ R6,inner
+		"11111110",
+		"11011111",	-- 006: DJNZ R7,outer
+		"11111010",
+		"11100100",	-- 008: CLR A
+		"01110101",	-- 009: MOV 30h,#100
+		"00110000",
+		"01100100",
+		"00000100",	-- 00C: count: INC A
+		"11010101",	-- 00D: DJNZ 30h,count
+		"00110000",
+		"11111100",
+		"10000000",	-- 010: done: SJMP done
+		"11111110",
+		others => "00000000"
+	);
+
+	constant PORT_POLL : ROM_TYPE := (
+		"11100101",	-- 000: poll: MOV A,P1
+		"10010000",
+		"01100000",	-- 002: JZ p1_zero
+		"00011110",
+		"10110100",	-- 004: CJNE A,#0FFh,p1_some
+		"11111111",
+		"00100110",
+		"11100101",	-- 007: MOV A,P0
+		"10000000",
+		"01110000",	-- 009: JNZ p0_set
+		"00000010",
+		"10000000",	-- 00B: SJMP poll
+		"11110011",
+		"10110100",	-- 00D: p0_set: CJNE A,#0AAh,poll
+		"10101010",
+		"11110000",
+		"11100101",	-- 010: MOV A,P2
+		"10100000",
+		"10110100",	-- 012: CJNE A,#55h,poll
+		"01010101",
+		"11101011",
+		"11100101",	-- 015: MOV A,P3
+		"10110000",
+		"01100000",	-- 017: JZ unlock
+		"00000010",
+		"10000000",	-- 019: SJMP poll
+		"11100101",
+		"01111111",	-- 01B: unlock: MOV R7,#8
+		"00001000",
+		"11011111",	-- 01D: spin: DJNZ R7,spin
+		"11111110",
+		"00000010",	-- 01F: LJMP poll
+		"00000000",
+		"00000000",
+		"11100101",	-- 022: p1_zero: MOV A,P2
+		"10100000",
+		"01110000",	-- 024: JNZ p2_count
+		"00000010",
+		"10000000",	-- 026: SJMP poll
+		"11011000",
+		"11111111",	-- 028: p2_count: MOV R7,A
+		"11011111",	-- 029: p2_loop: DJNZ R7,p2_loop
+		"11111110",
+		"10000000",	-- 02B: SJMP poll
+		"11010011",
+		"11111000",	-- 02D: p1_some: MOV R0,A
+		"10111000",	-- 02E: CJNE R0,#80h,p1_low
+		"10000000",
+		"00000010",
+		"10000000",	-- 031: SJMP poll
+		"11001101",
+		"00000001",	-- 033: p1_low: AJMP poll
+		"00000000",
+		others => "00000000"
+	);
+
+	constant CALL_WALK : ROM_TYPE := (
+		"01110101",	-- 000: start: MOV SP,#2Fh
+		"10000001",
+		"00101111",
+		"01111111",	-- 003: MOV R7,#3
+		"00000011",
+		"00010001",	-- 005: outer: ACALL add_sub
+		"00100110",
+		"00010010",	-- 007: LCALL sub_sub
+		"00000000",
+		"00101111",
+		"11011111",	-- 00A: DJNZ R7,outer
+		"11111001",
+		"01110100",	-- 00C: MOV A,#5
+		"00000101",
+		"00010100",	-- 00E: down: DEC A
+		"01110000",	-- 00F: JNZ down
+		"11111101",
+		"10110100",	-- 011: CJNE A,#0,bad
+		"00000000",
+		"00001110",
+		"01110101",	-- 014: MOV 30h,#4
+		"00110000",
+		"00000100",
+		"11010101",	-- 017: wait: DJNZ 30h,wait
+		"00110000",
+		"11111101",
+		"01111010",	-- 01A: MOV R2,#2
+		"00000010",
+		"10111010",	-- 01C: CJNE R2,#2,bad
+		"00000010",
+		"00000011",
+		"10110100",	-- 01F: CJNE A,#1,over
+		"00000001",
+		"00000010",
+		"10000000",	-- 022: bad: SJMP bad
+		"11111110",
+		"00000001",	-- 024: over: AJMP tail
+		"00111100",
+		"01110100",	-- 026: add_sub: MOV A,#7Fh
+		"01111111",
+		"00100100",	-- 028: ADD A,#1
+		"00000001",
+		"11010011",	-- 02A: SETB C
+		"00110100",	-- 02B: ADDC A,#80h
+		"10000000",
+		"11110100",	-- 02D: CPL A
+		"00100010",	-- 02E: RET
+		"11000011",	-- 02F: sub_sub: CLR C
+		"01110100",	-- 030: MOV A,#10h
+		"00010000",
+		"10010100",	-- 032: SUBB A,#21h
+		"00100001",
+		"00010001",	-- 034: ACALL nest
+		"00110111",
+		"00100010",	-- 036: RET
+		"00000100",	-- 037: nest: INC A
+		"01100000",	-- 038: JZ nest_z
+		"00000001",
+		"11100100",	-- 03A: CLR A
+		"00100010",	-- 03B: nest_z: RET
+		"11000011",	-- 03C: tail: CLR C
+		"00000010",	-- 03D: LJMP start
+		"00000000",
+		"00000000",
+		others => "00000000"
+	);
+
+	function image_data (n : integer) return ROM_TYPE is
+	begin
+		case n is
+			when 1 =>	return LOOP_BENCH;
+			when 2 =>	return PORT_POLL;
+			when 3 =>	return CALL_WALK;
+			when others =>	return PROGRAM;
+		end case;
+	end image_data;
+
+	constant ROM : ROM_TYPE := image_data(IMAGE);
+
 	begin
 
-	process (rst, rd, addr)
+	process (clk)
 	begin
-		if( rst = '1' ) then
-			data <= "--------";
-		elsif( rd = '1' ) then
-			data <= PROGRAM(conv_integer(addr));
-		else
-			data <= "--------";
+		if( clk'event and clk = '0' ) then
+			if( rd = '1' ) then
+				data <= ROM(conv_integer(addr(ADDR_WIDTH - 1 downto 0)));
+			end if;
 		end if;
 	end process;
 end Behavioral;
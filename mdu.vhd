@@ -0,0 +1,173 @@
+library IEEE;
+use IEEE.std_logic_1164.all;
+use IEEE.std_logic_arith.all;
+use IEEE.std_logic_unsigned.all;
+use work.constants.all;
+
+-- Multiply/divide unit in the SFR space, after the 80C517 MDU. It runs the
+-- 16x16 multiplier and a 32/16 divider while the core goes on executing.
+--
+-- MD0..MD3 (E9h..ECh)	operand A, result afterwards, least significant byte first
+-- MD4..MD5 (EDh..EEh)	operand B, remainder after a divide
+-- MDCON (EFh)	bit 0 OP   : 0 = MD1:MD0 * MD5:MD4 -> MD3..MD0
+--			     1 = MD3..MD0 / MD5:MD4 -> MD3..MD0, remainder MD5:MD4
+--		bit 5 DONE : set when a result is written back, requests the
+--			     MDU interrupt (IE bit 6). Writing 0 clears it, writing 1
+--			     leaves it as it is. START clears it too.
+--		bit 6 START: write 1 to start OP, always reads back 0
+--		bit 7 BSY  : read only, operation running
+--
+-- While BSY is set every write to MD0..MDCON is ignored: an operation can not
+-- be aborted, and DONE (and so the interrupt) can only be cleared once it has
+-- finished, when it is set anyway. A multiply takes 2 clocks, a divide 34.
+-- Dividing by zero gives a quotient of all ones.
+
+entity mdu is
+port (
+	rst		:	in std_logic;
+	clk		:	in std_logic;
+	addr		:	in std_logic_vector(7 downto 0);
+	ind		:	in std_logic;
+	wrByte	:	in std_logic;
+	diByte	:	in std_logic_vector(7 downto 0);
+	doByte	:	out std_logic_vector(7 downto 0);
+	irq		:	out std_logic		-- MDCON.DONE
+);
+end mdu;
+
+architecture rtl of mdu is
+
+	component multiplier is
+	generic (DWIDTH : integer := 16);
+	port (
+		clk	: in  std_logic;
+		a_i	: in  std_logic_vector(DWIDTH-1 downto 0);
+		b_i	: in  std_logic_vector(DWIDTH-1 downto 0);
+		prod_o 	: out std_logic_vector((DWIDTH*2)-1 downto 0));
+	end component;
+
+	component divider is
+	generic (DWIDTH : integer := 16;
+		   VWIDTH : integer := 16);
+	port (
+		clk		: in  std_logic;
+		reset		: in  std_logic;
+		start		: in  std_logic;
+		dividend_i	: in  std_logic_vector(DWIDTH-1 downto 0);
+		divisor_i	: in  std_logic_vector(VWIDTH-1 downto 0);
+		quotient_o	: out std_logic_vector(DWIDTH-1 downto 0);
+		remainder_o	: out std_logic_vector(VWIDTH-1 downto 0);
+		busy		: out std_logic;
+		done		: out std_logic);
+	end component;
+
+	signal md_a	:	std_logic_vector(31 downto 0);	-- MD3..MD0
+	signal md_b	:	std_logic_vector(15 downto 0);	-- MD5..MD4
+	signal op	:	std_logic;		-- MDCON.OP
+	signal done	:	std_logic;		-- MDCON.DONE
+	signal bsy	:	std_logic;		-- MDCON.BSY
+	signal arm	:	std_logic;		-- first clock of an operation, units still show the old result
+
+	signal mul_a	:	std_logic_vector(15 downto 0);
+	signal mul_b	:	std_logic_vector(15 downto 0);
+	signal mul_p	:	std_logic_vector(31 downto 0);
+	signal div_a	:	std_logic_vector(31 downto 0);
+	signal div_b	:	std_logic_vector(15 downto 0);
+	signal div_q	:	std_logic_vector(31 downto 0);
+	signal div_r	:	std_logic_vector(15 downto 0);
+	signal div_start	:	std_logic;
+	signal div_done	:	std_logic;
+
+begin
+
+	MUL: multiplier
+	generic map (DWIDTH => 16)
+	port map (clk, mul_a, mul_b, mul_p);
+
+	DIV: divider
+	generic map (DWIDTH => 32, VWIDTH => 16)
+	port map (clk, rst, div_start, div_a, div_b, div_q, div_r, open, div_done);
+
+	process (clk, rst)
+	begin
+	if (rst = '1') then
+		md_a <= (others => '0');
+		md_b <= (others => '0');
+		op <= '0';
+		done <= '0';
+		bsy <= '0';
+		arm <= '0';
+		mul_a <= (others => '0');
+		mul_b <= (others => '0');
+		div_a <= (others => '0');
+		div_b <= (others => '1');
+		div_start <= '0';
+
+	elsif (clk'event and clk = '1') then
+		arm <= '0';
+		div_start <= '0';
+
+		if (bsy = '1') then
+			if (arm = '1') then
+				null;
+			elsif (op = '0') then
+				md_a <= mul_p;
+				bsy <= '0';
+				done <= '1';
+			elsif (div_done = '1') then
+				md_a <= div_q;
+				md_b <= div_r;
+				bsy <= '0';
+				done <= '1';
+			end if;
+
+		elsif (wrByte = '1' and ind = '0') then
+			case addr is
+				when xE9   => md_a(7 downto 0) <= diByte;
+				when xEA   => md_a(15 downto 8) <= diByte;
+				when xEB   => md_a(23 downto 16) <= diByte;
+				when xEC   => md_a(31 downto 24) <= diByte;
+				when xED   => md_b(7 downto 0) <= diByte;
+				when xEE   => md_b(15 downto 8) <= diByte;
+				when xEF   => op <= diByte(0);
+						  if (diByte(5) = '0' or diByte(6) = '1') then
+							done <= '0';
+						  end if;
+						  if (diByte(6) = '1') then
+							bsy <= '1';
+							arm <= '1';
+							if (diByte(0) = '0') then
+								mul_a <= md_a(15 downto 0);
+								mul_b <= md_b;
+							else
+								div_a <= md_a;
+								div_b <= md_b;
+								div_start <= '1';
+							end if;
+						  end if;
+				when others =>
+			end case;
+		end if;
+	end if;
+	end process;
+
+	irq <= done;
+
+	-- read data, registered on the falling edge and picked by read_mux
+	process (clk)
+	begin
+	if (clk'event and clk = '0') then
+		case addr is
+			when xE9   => doByte <= md_a(7 downto 0);
+			when xEA   => doByte <= md_a(15 downto 8);
+			when xEB   => doByte <= md_a(23 downto 16);
+			when xEC   => doByte <= md_a(31 downto 24);
+			when xED   => doByte <= md_b(7 downto 0);
+			when xEE   => doByte <= md_b(15 downto 8);
+			when xEF   => doByte <= bsy & '0' & done & "0000" & op;
+			when others =>	doByte <= "00000000";
+		end case;
+	end if;
+	end process;
+
+end rtl;
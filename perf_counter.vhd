@@ -0,0 +1,119 @@
+library IEEE;
+use IEEE.std_logic_1164.all;
+use IEEE.std_logic_arith.all;
+use IEEE.std_logic_unsigned.all;
+use work.constants.all;
+
+-- Hardware performance counters, mapped into the SFR space so firmware can
+-- measure CPI on the core itself.
+--
+-- PMCON (F9h)	bit 0 FRZ : freeze both counters
+--		bit 1 CLR : write 1 to clear both counters, always reads back 0
+-- PMSEL (FAh)	bits 2-0  : event counted by the event counter
+--			    0 instructions retired
+--			    1 E-states held for a DIV AB result
+--			    2 RAM/SFR accesses issued
+--			    3 unimplemented opcodes executed
+--			    4 backward branches predicted and taken (E-states saved)
+--			    5 backward branches predicted and not taken
+--		bit 7     : counter seen through PMD0..PMD3 (0 = cycles, 1 = event)
+-- PMD0..PMD3 (FBh..FEh)	selected 32-bit counter, least significant byte first
+--
+-- The cycle counter counts every E-state. Freeze the counters before reading
+-- PMD0..PMD3 to get a coherent 32-bit value.
+
+entity perf_counter is
+port (
+	rst		:	in std_logic;
+	clk		:	in std_logic;
+	addr		:	in std_logic_vector(7 downto 0);
+	ind		:	in std_logic;
+	wrByte	:	in std_logic;
+	rdByte	:	in std_logic;
+	diByte	:	in std_logic_vector(7 downto 0);
+	doByte	:	out std_logic_vector(7 downto 0);
+
+	ev_retire	:	in std_logic;	-- an instruction retired
+	ev_div_wait	:	in std_logic;	-- E-state spent waiting on div_done
+	ev_ram	:	in std_logic;		-- a RAM/regfile access was issued, one clock each
+	ev_illegal	:	in std_logic;		-- executed an unimplemented opcode
+	ev_pred_hit	:	in std_logic;		-- predicted branch taken, one E-state saved
+	ev_pred_miss	:	in std_logic		-- predicted branch not taken
+);
+end perf_counter;
+
+architecture rtl of perf_counter is
+
+	constant PM_EVT_RETIRE	: std_logic_vector(2 downto 0) := "000";
+	constant PM_EVT_DIVWAIT	: std_logic_vector(2 downto 0) := "001";
+	constant PM_EVT_RAM	: std_logic_vector(2 downto 0) := "010";
+	constant PM_EVT_ILLEGAL	: std_logic_vector(2 downto 0) := "011";
+	constant PM_EVT_PREDHIT	: std_logic_vector(2 downto 0) := "100";
+	constant PM_EVT_PREDMISS	: std_logic_vector(2 downto 0) := "101";
+
+	signal PMCON	:	std_logic_vector(7 downto 0);
+	signal PMSEL	:	std_logic_vector(7 downto 0);
+	signal cyc_cnt	:	std_logic_vector(31 downto 0);	-- clock cycles
+	signal evt_cnt	:	std_logic_vector(31 downto 0);	-- selected event
+	signal sel_cnt	:	std_logic_vector(31 downto 0);
+	signal evt_hit	:	std_logic;
+
+begin
+
+	with PMSEL(2 downto 0) select
+		evt_hit <=	ev_retire	when PM_EVT_RETIRE,
+				ev_div_wait	when PM_EVT_DIVWAIT,
+				ev_ram	when PM_EVT_RAM,
+				ev_illegal	when PM_EVT_ILLEGAL,
+				ev_pred_hit	when PM_EVT_PREDHIT,
+				ev_pred_miss	when PM_EVT_PREDMISS,
+				'0'		when others;
+
+	sel_cnt <= evt_cnt when PMSEL(7) = '1' else cyc_cnt;
+
+	process (clk, rst)
+	begin
+	if (rst = '1') then
+		PMCON <= (others => '0');
+		PMSEL <= (others => '0');
+		cyc_cnt <= (others => '0');
+		evt_cnt <= (others => '0');
+
+	elsif (clk'event and clk = '1') then
+		if (wrByte = '1' and ind = '0' and addr = xF9 and diByte(1) = '1') then
+			cyc_cnt <= (others => '0');
+			evt_cnt <= (others => '0');
+		elsif (PMCON(0) = '0') then
+			cyc_cnt <= cyc_cnt + '1';
+			if (evt_hit = '1') then
+				evt_cnt <= evt_cnt + '1';
+			end if;
+		end if;
+
+		if (wrByte = '1' and ind = '0') then
+			case addr is
+				when xF9   => PMCON <= diByte(7 downto 2) & '0' & diByte(0);
+				when xFA   => PMSEL <= diByte;
+				when others =>
+			end case;
+		end if;
+	end if;
+	end process;
+
+	-- read data, registered on the falling edge and picked by read_mux
+	process (clk)
+	begin
+	if (clk'event and clk = '0') then
+		case addr is
+			when xF9   => doByte <= PMCON;
+			when xFA   => doByte <= PMSEL;
+			when xFB   => doByte <= sel_cnt(7 downto 0);
+			when xFC   => doByte <= sel_cnt(15 downto 8);
+			when xFD   => doByte <= sel_cnt(23 downto 16);
+			when xFE   => doByte <= sel_cnt(31 downto 24);
+			when others =>	doByte <= "00000000";
+		end case;
+	end if;
+	end process;
+
+end rtl;
@@ -0,0 +1,90 @@
+library IEEE;
+use IEEE.std_logic_1164.all;
+use IEEE.std_logic_arith.all;
+use IEEE.std_logic_unsigned.all;
+use work.constants.all;
+
+-- Read data mux for the RAM/SFR bus. Every slave registers its read data on
+-- the falling edge and drives it all the time. The source is picked here with
+-- a one-hot select registered on the same edge, so the sequencer still sees
+-- the data by the next rising edge, with no tri-states and no latches.
+--
+-- lower RAM, @Ri and stack (addr(7) = '0' or ind = '1')	internal_ram
+-- PMCON..PMD3 (F9h-FEh)				perf_counter
+-- MD0..MDCON (E9h-EFh)				mdu
+-- any other SFR					regfile
+-- Bit addresses follow the same split, bit reads never set ind.
+
+entity read_mux is
+port (
+	clk		:	in std_logic;
+	addr		:	in std_logic_vector(7 downto 0);
+	ind		:	in std_logic;
+
+	ram_byte	:	in std_logic_vector(7 downto 0);
+	ram_bit	:	in std_logic;
+	sfr_byte	:	in std_logic_vector(7 downto 0);
+	sfr_bit	:	in std_logic;
+	pm_byte	:	in std_logic_vector(7 downto 0);
+	mdu_byte	:	in std_logic_vector(7 downto 0);
+
+	doByte	:	out std_logic_vector(7 downto 0);
+	doBit		:	out std_logic
+);
+end read_mux;
+
+architecture rtl of read_mux is
+
+	constant SEL_RAM	: integer := 0;
+	constant SEL_SFR	: integer := 1;
+	constant SEL_PM	: integer := 2;
+	constant SEL_MDU	: integer := 3;
+
+	signal sel_nx	:	std_logic_vector(3 downto 0);
+	signal sel	:	std_logic_vector(3 downto 0);
+
+begin
+
+	process (addr, ind)
+	begin
+		sel_nx <= (others => '0');
+		if (addr(7) = '0' or ind = '1') then
+			sel_nx(SEL_RAM) <= '1';
+		elsif (addr >= xF9 and addr <= xFE) then
+			sel_nx(SEL_PM) <= '1';
+		elsif (addr >= xE9 and addr <= xEF) then
+			sel_nx(SEL_MDU) <= '1';
+		else
+			sel_nx(SEL_SFR) <= '1';
+		end if;
+	end process;
+
+	process (clk)
+	begin
+		if (clk'event and clk = '0') then
+			sel <= sel_nx;
+		end if;
+	end process;
+
+	process (sel, ram_byte, ram_bit, sfr_byte, sfr_bit, pm_byte, mdu_byte)
+		variable v	:	std_logic_vector(7 downto 0);
+	begin
+		v := (others => '0');
+		if (sel(SEL_RAM) = '1') then
+			v := v or ram_byte;
+		end if;
+		if (sel(SEL_SFR) = '1') then
+			v := v or sfr_byte;
+		end if;
+		if (sel(SEL_PM) = '1') then
+			v := v or pm_byte;
+		end if;
+		if (sel(SEL_MDU) = '1') then
+			v := v or mdu_byte;
+		end if;
+		doByte <= v;
+
+		doBit <= (sel(SEL_RAM) and ram_bit) or (sel(SEL_SFR) and sfr_bit);
+	end process;
+
+end rtl;
@@ -9,13 +9,15 @@ port (
  	rst		:	in std_logic;
 	clk		:	in std_logic;
 	addr 		: 	in std_logic_vector(7 downto 0);
-	wrBit		:	in std_logic;
+	ind		:	in std_logic;	-- indirect access, goes to the upper RAM instead
+	wrBit		:	in std_logic;	-- write strobes are one clock pulses
 	wrByte	:	in std_logic;
 	rdBit		:	in std_logic;
 	rdByte	:	in std_logic;
 	
 	diBit		:	in std_logic;
 	diByte	:	in std_logic_vector(7 downto 0);
+	bitOp		:	in std_logic_vector(2 downto 0);
 
 	doBit		:	out std_logic;
 	doByte	:	out std_logic_vector(7 downto 0);
@@ -33,7 +35,23 @@ port (
 	P0_in		:	in std_logic_vector(7 downto 0);
 	P1_in		:	in std_logic_vector(7 downto 0);
 	P2_in		:	in std_logic_vector(7 downto 0);
-	P3_in		:	in std_logic_vector(7 downto 0)
+	P3_in		:	in std_logic_vector(7 downto 0);
+
+	dptr_inc	:	in std_logic;	-- DPTR + 1 on the selected data pointer
+	dptr_ld	:	in std_logic;	-- load the selected data pointer from dptr_di
+	dptr_di	:	in std_logic_vector(15 downto 0);
+	dptr		:	out std_logic_vector(15 downto 0);	-- selected data pointer
+
+	sp_ld		:	in std_logic;	-- load SP from sp_di (call/return)
+	sp_di		:	in std_logic_vector(7 downto 0);
+	SP_out	:	out std_logic_vector(7 downto 0);
+	ACC_out	:	out std_logic_vector(7 downto 0);	-- for the trace port
+	PSW_out	:	out std_logic_vector(7 downto 0);
+
+	div_wb	:	in std_logic;	-- DIV AB result: ACC <= div_q, B <= div_r, CY <= 0, OV <= div_ov
+	div_ov	:	in std_logic;
+	div_q		:	in std_logic_vector(7 downto 0);
+	div_r		:	in std_logic_vector(7 downto 0)
 );
 end entity;
 
@@ -52,10 +70,23 @@ port
 );
 end component;
 
+component bit_unit is
+port (
+	op		:	in std_logic_vector(2 downto 0);
+	sel		:	in std_logic_vector(2 downto 0);
+	diBit		:	in std_logic;
+	byte_in	:	in std_logic_vector(7 downto 0);
+	byte_out	:	out std_logic_vector(7 downto 0);
+	bit_out	:	out std_logic);
+end component;
+
 	signal ACC	:	std_logic_vector(7 downto 0);-- accumulator
 	signal B	:	std_logic_vector(7 downto 0);
 	signal DPH	:	std_logic_vector(7 downto 0);
 	signal DPL	:	std_logic_vector(7 downto 0);
+	signal DPH1	:	std_logic_vector(7 downto 0);-- second data pointer
+	signal DPL1	:	std_logic_vector(7 downto 0);
+	signal DPS	:	std_logic_vector(7 downto 0);-- bit 0 selects DPTR1
 	signal IE	:	std_logic_vector(7 downto 0);
 	signal IP	:	std_logic_vector(7 downto 0);
 	signal PCON	:	std_logic_vector(7 downto 0);
@@ -70,8 +101,20 @@ end component;
 	signal TL0	:	std_logic_vector(7 downto 0);
 	signal TL1	:	std_logic_vector(7 downto 0);
 	signal TMOD	:	std_logic_vector(7 downto 0);
+	signal P0	:	std_logic_vector(7 downto 0);-- port latches
+	signal P1	:	std_logic_vector(7 downto 0);
+	signal P2	:	std_logic_vector(7 downto 0);
 	signal P3	:	std_logic_vector(7 downto 0);
 
+	signal bit_reg	:	std_logic_vector(7 downto 0);-- SFR holding the addressed bit
+	signal bit_new	:	std_logic_vector(7 downto 0);
+	signal bit_old	:	std_logic;
+	signal bit_hit	:	std_logic;
+
+	signal dptr_sel	:	std_logic_vector(15 downto 0);
+	signal do_reg	:	std_logic_vector(7 downto 0);
+	signal dptr_nx	:	std_logic_vector(15 downto 0);
+
 begin
 
 ext_int:	ext_interrupt
@@ -86,9 +129,92 @@ port map
 	oP3_3 => P3(3)	
 );
 
-	process (clk, rst, rdByte, rdBit, addr)
+BITU: bit_unit
+port map
+(
+	op => bitOp,
+	sel => addr(2 downto 0),
+	diBit => diBit,
+	byte_in => bit_reg,
+	byte_out => bit_new,
+	bit_out => bit_old
+);
+
+	-- bit addressable SFRs. Bit reads of a port see the pins, a
+	-- read-modify-write (wrBit) works on the port latch.
+	process (addr, rdBit, ACC, B, IE, IP, PSW, SCON, TCON, P0, P1, P2, P3, P0_in, P1_in, P2_in, P3_in)
 		variable U	:	std_logic_vector(7 downto 0);
-		variable L	:	INTEGER;
+	begin
+		U := addr(7 downto 3)&"000";
+		bit_hit <= '1';
+		case U is
+			when xE0   => bit_reg <= ACC;
+			when xF0   => bit_reg <= B;
+			when xA8   => bit_reg <= IE;
+			when xB8   => bit_reg <= IP;
+			when xD0   => bit_reg <= PSW;
+			when x98   => bit_reg <= SCON;
+			when x88   => bit_reg <= TCON;
+			when x80   => if (rdBit = '1') then bit_reg <= P0_in; else bit_reg <= P0; end if;
+			when x90   => if (rdBit = '1') then bit_reg <= P1_in; else bit_reg <= P1; end if;
+			when xA0   => if (rdBit = '1') then bit_reg <= P2_in; else bit_reg <= P2; end if;
+			when xB0   => if (rdBit = '1') then bit_reg <= P3_in; else bit_reg <= P3; end if;
+			when others =>	bit_reg <= (others => '0');
+					bit_hit <= '0';
+		end case;
+	end process;
+
+
+	-- DPTR is a 16 bit register for the sequencer, DPS picks which one
+	dptr_sel <= DPH1 & DPL1 when DPS(0) = '1' else DPH & DPL;
+	dptr_nx <= dptr_sel + '1';
+	dptr <= dptr_sel;
+
+	SP_out <= SP;
+	ACC_out <= ACC;
+	PSW_out <= PSW;
+
+	-- SFR read data, registered on the falling edge and picked by read_mux
+	-- for direct accesses above 7Fh
+	process (clk)
+	begin
+	if (clk'event and clk = '0') then
+		case addr is
+				when xE0   => do_reg <= ACC; 
+				when xF0   => do_reg <= B;	   
+				when x83   => do_reg <= DPH; 
+				when x82   => do_reg <= DPL;	
+				when x85   => do_reg <= DPH1;
+				when x84   => do_reg <= DPL1;
+				when x86   => do_reg <= DPS;
+				when xA8   => do_reg <= IE;	  
+				when xB8   => do_reg <= IP;	  
+				when x80   => do_reg <= P0_in;	  
+				when x90   => do_reg <= P1_in;	  
+				when xA0   => do_reg <= P2_in;	  
+				when xB0   => do_reg <= P3_in;	  
+				when x87   => do_reg <= PCON;	
+				when xD0   => do_reg <= PSW;	 
+				when x99   => do_reg <= SBUF;	 
+				when x98   => do_reg <= SCON;	 
+				when x81   => do_reg <= SP;	  
+				when x88   => do_reg <= TCON;
+				when x8C   => do_reg <= TH0;	 
+				when x8D   => do_reg <= TH1;	  
+				when x8A   => do_reg <= TL0;	  
+				when x8B   => do_reg <= TL1;	  
+				when x89   => do_reg <= TMOD;	  
+				when others =>	do_reg <= "00000000";		
+		end case;
+		doBit <= bit_old and bit_hit;
+	end if;
+	end process;
+
+	doByte <= do_reg;
+
+	process (clk, rst)
+		variable U	:	std_logic_vector(7 downto 0);
+		variable V	:	std_logic_vector(7 downto 0);
 begin
 	--TCON <= TCON_temp; 
 	if (rst = '1') then
@@ -96,6 +222,9 @@ begin
             B      <= "00000000";
             DPH    <= "00000000";
             DPL    <= "00000000";
+            DPH1   <= "00000000";
+            DPL1   <= "00000000";
+            DPS    <= "00000000";
             IE     <= "00000000";
             IP     <= "00000000";
             PCON   <= "00000000";
@@ -113,67 +242,29 @@ begin
             P1_out <= "11111111";
             P2_out <= "11111111";
             P3_out <= "00000000";
+		P0	 <= "11111111";
+		P1	 <= "11111111";
+		P2	 <= "11111111";
 		P3	 <= "00000000";
-		doByte <= "ZZZZZZZZ";
-		doBit <= 'Z';
-  
-	elsif (rdByte = '1') then
-		case addr is
-				when xE0   => doByte <= ACC; 
-				when xF0   => doByte <= B;	   
-				when x83   => doByte <= DPH; 
-				when x82   => doByte <= DPL;	
-				when xA8   => doByte <= IE;	  
-				when xB8   => doByte <= IP;	  
-				when x80   => doByte <= P0_in;	  
-				when x90   => doByte <= P1_in;	  
-				when xA0   => doByte <= P2_in;	  
-				when xB0   => doByte <= P3_in;	  
-				when x87   => doByte <= PCON;	
-				when xD0   => doByte <= PSW;	 
-				when x99   => doByte <= SBUF;	 
-				when x98   => doByte <= SCON;	 
-				when x81   => doByte <= SP;	  
-				when x88   => doByte <= TCON;
-				when x8C   => doByte <= TH0;	 
-				when x8D   => doByte <= TH1;	  
-				when x8A   => doByte <= TL0;	  
-				when x8B   => doByte <= TL1;	  
-				when x89   => doByte <= TMOD;	  
-				when others =>	doByte <= "ZZZZZZZZ";		
-			end case;
-
-	elsif (rdBit = '1') then
-		L := conv_integer(addr(2 downto 0));
-		U := addr(7 downto 3)&"000";
-			case U is
-				when xE0   => doBit <= ACC(L);
-				when xF0   => doBit <= B(L);
-				when xA8   => doBit <= IE(L);
-				when xB8   => doBit <= IP(L);
-				when x80   => doBit <= P0_in(L);
-				when x90   => doBit <= P1_in(L);
-				when xA0   => doBit <= P2_in(L);
-				when xB0   => doBit <= P3_in(L);
-				when xD0   => doBit <= PSW(L);
-				when x81   => doBit <= SP(L);
-				when x98   => doBit <= SCON(L);
-				when x88   => doBit <= TCON(L);
-				when others =>	doBit <= 'Z';	
-			end case;
-	
+
 	elsif (clk' event and clk = '1') then
-		if (wrByte = '1') then
+		if (wrByte = '1' and ind = '0') then
 				case addr is
 					when xE0   => ACC <= diByte; 
 					when xF0   => B <= diByte;	   
 					when x83   => DPH <= diByte; 
 					when x82   => DPL <= diByte;	
+					when x85   => DPH1 <= diByte;
+					when x84   => DPL1 <= diByte;
+					when x86   => DPS <= "0000000" & diByte(0);
 					when xA8   => IE <= diByte;	  
 					when xB8   => IP <= diByte;	  
 					when x80   => P0_out <= diByte;	  
+							  P0	 <= diByte;	  
 					when x90   => P1_out <= diByte;	  
+							  P1	 <= diByte;	  
 					when xA0   => P2_out <= diByte;	  
+							  P2	 <= diByte;	  
 					when xB0   => P3_out <= diByte;
 							  P3	 <= diByte;	  
 					when x87   => PCON <= diByte;	
@@ -191,28 +282,59 @@ begin
 				end case;		
 		
 		elsif (wrBit = '1') then
-			L := conv_integer(addr(2 downto 0));
 			U := addr(7 downto 3)&"000";
 			case U is
-					when xE0   => ACC(L) <= diBit;
-					when xF0   => B(L)<= diBit;
-					when xA8   => IE(L)<= diBit;
-					when xB8   => IP(L)<= diBit;
-					when x80   => P0_out(L)<= diBit;
-					when x90   => P1_out(L)<= diBit;
-					when xA0   => P2_out(L)<= diBit;
-					when xB0   => P3_out(L)<= diBit;
-							    P3(L)<= diBit;
-					when xD0   => PSW(L)<= diBit;
-					when x81   => SP(L)<= diBit;
-					when x98   => SCON(L)<= diBit;
-					when x88   => TCON(L)<= diBit;
+					when xE0   => ACC <= bit_new;
+					when xF0   => B <= bit_new;
+					when xA8   => IE <= bit_new;
+					when xB8   => IP <= bit_new;
+					when x80   => P0_out <= bit_new;
+							    P0 <= bit_new;
+					when x90   => P1_out <= bit_new;
+							    P1 <= bit_new;
+					when xA0   => P2_out <= bit_new;
+							    P2 <= bit_new;
+					when xB0   => P3_out <= bit_new;
+							    P3 <= bit_new;
+					when xD0   => PSW <= bit_new;
+					when x98   => SCON <= bit_new;
+					when x88   => TCON <= bit_new;
 				when others =>			
 				end case;
 
 		else
 			TCON <= TCON_temp;
 		end if;		
+
+		if (dptr_ld = '1' or dptr_inc = '1') then
+			if (dptr_ld = '1') then
+				U := dptr_di(15 downto 8);
+				V := dptr_di(7 downto 0);
+			else
+				U := dptr_nx(15 downto 8);
+				V := dptr_nx(7 downto 0);
+			end if;
+			if (DPS(0) = '1') then
+				DPH1 <= U;
+				DPL1 <= V;
+			else
+				DPH <= U;
+				DPL <= V;
+			end if;
+		end if;
+
+		if (sp_ld = '1') then
+			SP <= sp_di;
+		end if;
+
+		-- the sequencer holds back every instruction that could touch
+		-- ACC, B or PSW until this write is done
+		if (div_wb = '1') then
+			ACC <= div_q;
+			B <= div_r;
+			PSW(7) <= '0';
+			PSW(2) <= div_ov;
+		end if;
 	end if;
 
 	IE_out <= IE;
@@ -1,22 +1,25 @@
 library IEEE;
 use IEEE.std_logic_1164.all;
+use IEEE.std_logic_arith.all;
 use IEEE.std_logic_unsigned.all;
 use work.constants.all;
 
 entity sequencer2 is
+    generic (BRANCH_PREDICT : boolean := true);	-- false: no static prediction, for comparison
     port(
 		rst                : in  std_logic;
 		clk              	 : in  std_logic;
 		ale		  	 : out std_logic;
 		psen		 	 : out std_logic;
 
-		alu_op_code	 	 : out  std_logic_vector (3 downto 0);
+		alu_op_code	 	 : out  std_logic_vector (4 downto 0);
 		alu_src_1L		 : out  std_logic_vector (7 downto 0);
 		alu_src_1H		 : out  std_logic_vector (7 downto 0);
 		alu_src_2L		 : out  std_logic_vector (7 downto 0);
 		alu_src_2H		 : out  std_logic_vector (7 downto 0);
 		alu_by_wd		 : out  std_logic;             -- byte(0)/word(1) instruction
 		alu_cy_bw		 : out  std_logic;             -- carry/borrow bit
+		alu_ac_in		 : out  std_logic;             -- auxiliary carry for DA
 		alu_ans_L		 : in std_logic_vector (7 downto 0);
 		alu_ans_H		 : in std_logic_vector (7 downto 0);
 		alu_cy		 	 : in std_logic;             -- carry out of bit 7/15
@@ -28,6 +31,7 @@ entity sequencer2 is
 		quotient_o		 : in std_logic_vector(15 downto 0); 
 		remainder_o	 	 : in std_logic_vector(15 downto 0);
 		div_done		 : in std_logic ;
+		div_start		 : out std_logic;		-- latch dividend_i/divisor_i and divide
 
 		mul_a_i		 	 : out  std_logic_vector(15 downto 0);  -- Multiplicand
 		mul_b_i		 	 : out  std_logic_vector(15 downto 0);  -- Multiplicator
@@ -42,6 +46,11 @@ entity sequencer2 is
 		i_ram_diBit   	 : out std_logic; 
 		i_ram_doByte   	 : in std_logic_vector(7 downto 0); 
 		i_ram_doBit   	 : in std_logic; 
+		i_ram_ind		 : out std_logic;		-- indirect access (@Ri, stack)
+		i_ram_bitOp		 : out std_logic_vector(2 downto 0);	-- operation applied by i_ram_wrBit
+		i_ram_pair		 : out std_logic;		-- stack access to addr and addr + 1
+		i_ram_diHi		 : out std_logic_vector(7 downto 0);	-- byte at addr + 1
+		i_ram_doHi		 : in std_logic_vector(7 downto 0);
 		
 		i_rom_addr       : out std_logic_vector (15 downto 0);
 		i_rom_data       : in  std_logic_vector (7 downto 0);
@@ -49,7 +58,30 @@ entity sequencer2 is
 		
 		pc_debug	 	 : out std_logic_vector (15 downto 0);
 		interrupt_flag	 : in  std_logic_vector (2 downto 0);
-		erase_flag	 : out std_logic);
+		erase_flag	 : out std_logic;
+
+		instr_retire	 : out std_logic;		-- one clock per retired instruction
+		div_wait		 : out std_logic;		-- E-state spent waiting on div_done
+		ram_access		 : out std_logic;		-- one clock per RAM/SFR access issued
+
+		trace_pc		 : out std_logic_vector (15 downto 0);	-- retired instruction, valid with instr_retire
+		trace_ir		 : out std_logic_vector (7 downto 0);
+		trace_taken		 : out std_logic;
+		illegal_op		 : out std_logic;		-- executed an opcode marked CLS_UNDEF
+		pred_hit		 : out std_logic;		-- backward branch predicted taken and taken
+		pred_miss		 : out std_logic;		-- backward branch predicted taken, not taken
+
+		dptr_inc		 : out std_logic;		-- regfile: DPTR + 1
+		dptr_ld			 : out std_logic;		-- regfile: DPTR <= dptr_di
+		dptr_di			 : out std_logic_vector (15 downto 0);
+		dptr			 : in  std_logic_vector (15 downto 0);	-- selected data pointer
+
+		sp_ld			 : out std_logic;		-- regfile: SP <= sp_di
+		sp_di			 : out std_logic_vector (7 downto 0);
+		sp				 : in  std_logic_vector (7 downto 0);
+
+		div_wb			 : out std_logic;		-- regfile: DIV AB result to A, B and PSW
+		div_ov			 : out std_logic);
 
 end sequencer2;
 
@@ -67,10 +99,76 @@ architecture seq_arch of sequencer2 is
 	signal AR				: std_logic_vector(7 downto 0);		-- Address Register
 	signal DR				: std_logic_vector(7 downto 0);		-- Data Register
 	signal int_hold			: std_logic;
+	signal ir_valid			: std_logic;		-- IR holds a fetched instruction
+	signal ir_pc			: std_logic_vector(15 downto 0);	-- address of the instruction in IR
+	signal br_taken			: std_logic;		-- the instruction in IR changed the flow
+	signal PSWR				: std_logic_vector(7 downto 0);		-- PSW read at the start of execute
+	signal br_target		: std_logic_vector(15 downto 0);	-- PC + rel, rel on i_rom_data
+	signal pred_spec		: std_logic;		-- predicted target opcode is on i_rom_data
+	signal pred_pc			: std_logic_vector(15 downto 0);	-- its address
+	signal pw_valid			: std_logic;		-- posted write waiting for the bus
+	signal pw_addr			: std_logic_vector(7 downto 0);
+	signal pw_data			: std_logic_vector(7 downto 0);
+	signal div_pend			: std_logic;		-- DIV AB result not written back yet
+	signal div_arm			: std_logic;		-- divider has not seen div_start yet
+	signal div_wr			: std_logic;		-- div_wb
+	signal div_safe			: std_logic;		-- instruction in IR cannot touch ACC, B or the PSW flags
+	signal div_hold			: std_logic;
+
+	signal dec_rd			: std_logic;
+	signal dec_class		: std_logic_vector(3 downto 0);
+	signal dec_src			: std_logic_vector(2 downto 0);
+	signal dec_dst			: std_logic_vector(2 downto 0);
+	signal dec_alu			: std_logic_vector(4 downto 0);
+	signal dec_flags		: std_logic_vector(1 downto 0);
+
+	component decode_rom
+	port (
+		clk		:	in std_logic;
+		rd		:	in std_logic;
+		opcode	:	in std_logic_vector(7 downto 0);
+		dec_class	:	out std_logic_vector(3 downto 0);
+		dec_src	:	out std_logic_vector(2 downto 0);
+		dec_dst	:	out std_logic_vector(2 downto 0);
+		dec_alu	:	out std_logic_vector(4 downto 0);
+		dec_flags	:	out std_logic_vector(1 downto 0)
+	);
+	end component;
 
 begin
 
+	-- branch address unit shared by all relative branches
+	br_target <= PC + SXT(i_rom_data, 16);
+
+	-- the decode word is registered together with IR
+	dec_rd <= '1' when ((cpu_state = T0 and exe_state = E1) or pred_spec = '1') else '0';
+
+	DECODER : decode_rom port map (clk, dec_rd, i_rom_data, dec_class, dec_src, dec_dst, dec_alu, dec_flags);
+
+	-- DIV AB retires as soon as the divider is started. Instructions that
+	-- cannot see its result keep running, any other one is held in E0 until
+	-- regfile has taken the result.
+	div_safe <= '1' when (dec_class = CLS_NOP
+			or ((dec_class = CLS_MOV or dec_class = CLS_UNARY)
+				and dec_src /= AM_ACC and dec_src /= AM_DIR
+				and dec_dst /= AM_ACC and dec_dst /= AM_DIR and dec_flags = FL_NONE)
+			or (dec_class = CLS_SEQ and (IR(3 downto 0) = "0001"	--AJMP, ACALL
+				or IR = "00000010" or IR = "00010010" or IR = "10000000"	--LJMP, LCALL, SJMP
+				or IR = "00100010" or IR = "00110010"	--RET, RETI
+				or IR = "10010000" or IR = "10100011"	--MOV DPTR,#data16, INC DPTR
+				or IR(7 downto 3) = "11011")))	--DJNZ Rn,rel
+		else '0';
+	div_hold <= '1' when ((div_pend = '1' or div_wr = '1') and div_safe = '0') else '0';
+	div_wb <= div_wr;
+
+	-- E-states an instruction is held for a DIV AB result
+	div_wait <= '1' when (cpu_state = T1 and exe_state = E0 and div_hold = '1') else '0';
+
+	pc_debug <= ir_pc;
+
     process(rst, clk)
+	variable opnd	: std_logic_vector(7 downto 0);	-- source operand
+	variable dst	: std_logic_vector(7 downto 0);	-- destination address
 	
 ------------------------------------------------------------------
 	procedure ROM_READ (addr: std_logic_vector(15 downto 0)) is
@@ -82,39 +180,168 @@ begin
 	procedure RAM_READ_BIT (addr: std_logic_vector(7 downto 0)) is
 	begin
 		i_ram_addr <= addr;
+		i_ram_ind <= '0';
+		i_ram_pair <= '0';
 		i_ram_wrBit <= '0';
 		i_ram_wrByte <= '0';
 		i_ram_rdBit <= '1';
 		i_ram_rdByte <= '0';
+		ram_access <= '1';
 	end RAM_READ_BIT;
 ------------------------------------------------------------------
 	procedure RAM_READ_BYTE (addr: std_logic_vector(7 downto 0)) is
 	begin
 		i_ram_addr <= addr;
+		i_ram_ind <= '0';
+		i_ram_pair <= '0';
 		i_ram_wrBit <= '0';
 		i_ram_wrByte <= '0';
 		i_ram_rdBit <= '0';
 		i_ram_rdByte <= '1';
+		ram_access <= '1';
 	end RAM_READ_BYTE;
 ------------------------------------------------------------------
 	procedure RAM_WRITE_BIT (addr: std_logic_vector(7 downto 0)) is
 	begin
 		i_ram_addr <= addr;
+		i_ram_ind <= '0';
+		i_ram_pair <= '0';
+		i_ram_bitOp <= BIT_OPC_MOV;
 		i_ram_wrBit <= '1';
 		i_ram_wrByte <= '0';
 		i_ram_rdBit <= '0';
 		i_ram_rdByte <= '0';
+		ram_access <= '1';
 	end RAM_WRITE_BIT;
+------------------------------------------------------------------
+	-- single clock set/clear/complement, i_ram_doBit returns the old bit
+	procedure RAM_RMW_BIT (addr: std_logic_vector(7 downto 0); op: std_logic_vector(2 downto 0)) is
+	begin
+		RAM_WRITE_BIT(addr);
+		i_ram_bitOp <= op;
+	end RAM_RMW_BIT;
 ------------------------------------------------------------------
 	procedure RAM_WRITE_BYTE (addr: std_logic_vector(7 downto 0)) is
 	begin
 		i_ram_addr <= addr;
+		i_ram_ind <= '0';
+		i_ram_pair <= '0';
 		i_ram_wrBit <= '0';
 		i_ram_wrByte <= '1';
 		i_ram_rdBit <= '0';
 		i_ram_rdByte <= '0';
+		ram_access <= '1';
 	end RAM_WRITE_BYTE;
 ------------------------------------------------------------------
+	-- direct byte write for when the bus is already taken this clock. It is
+	-- held in the posted-write buffer and goes out during the next fetch,
+	-- which never uses the RAM bus.
+	procedure RAM_POST_BYTE (addr: std_logic_vector(7 downto 0); data: std_logic_vector(7 downto 0)) is
+	begin
+		pw_addr <= addr;
+		pw_data <= data;
+		pw_valid <= '1';
+	end RAM_POST_BYTE;
+------------------------------------------------------------------
+	-- @Ri and stack accesses: 80h-FFh reach the upper RAM, not the SFRs
+	procedure RAM_READ_IDATA (addr: std_logic_vector(7 downto 0)) is
+	begin
+		RAM_READ_BYTE(addr);
+		i_ram_ind <= '1';
+	end RAM_READ_IDATA;
+------------------------------------------------------------------
+	procedure RAM_WRITE_IDATA (addr: std_logic_vector(7 downto 0)) is
+	begin
+		RAM_WRITE_BYTE(addr);
+		i_ram_ind <= '1';
+	end RAM_WRITE_IDATA;
+------------------------------------------------------------------
+	-- stack pair: addr through i_ram_diByte/doByte and addr + 1 through
+	-- i_ram_diHi/doHi in the same clock
+	procedure RAM_READ_PAIR (addr: std_logic_vector(7 downto 0)) is
+	begin
+		RAM_READ_IDATA(addr);
+		i_ram_pair <= '1';
+	end RAM_READ_PAIR;
+------------------------------------------------------------------
+	procedure RAM_WRITE_PAIR (addr: std_logic_vector(7 downto 0)) is
+	begin
+		RAM_WRITE_IDATA(addr);
+		i_ram_pair <= '1';
+	end RAM_WRITE_PAIR;
+------------------------------------------------------------------
+	-- no bus access this clock, e.g. while DPTR is updated in place
+	procedure RAM_IDLE is
+	begin
+		i_ram_pair <= '0';
+		i_ram_wrBit <= '0';
+		i_ram_wrByte <= '0';
+		i_ram_rdBit <= '0';
+		i_ram_rdByte <= '0';
+	end RAM_IDLE;
+------------------------------------------------------------------
+	-- load the opcode on i_rom_data, fetched from addr, and start execute
+	procedure LOAD_IR (addr: std_logic_vector(15 downto 0)) is
+	begin
+		IR <= i_rom_data;
+		-- the previous instruction is complete once the next one is fetched
+		instr_retire <= ir_valid;
+		trace_pc <= ir_pc;
+		trace_ir <= IR;
+		trace_taken <= br_taken;
+		ir_valid <= '1';
+		ir_pc <= addr;
+		br_taken <= '0';
+		PC <= addr + '1';
+		cpu_state <= T1;
+		exe_state <= E0;
+	end LOAD_IR;
+------------------------------------------------------------------
+	-- taken branch: fetch the target now, T0 E1 loads it into IR
+	procedure BRANCH_TO (target: std_logic_vector(15 downto 0)) is
+	begin
+		ROM_READ(target);
+		PC <= target;
+		br_taken <= '1';
+		cpu_state <= T0;
+		exe_state <= E1;
+	end BRANCH_TO;
+------------------------------------------------------------------
+	-- static prediction: a backward branch (rel on i_rom_data negative) is
+	-- taken, so fetch its target opcode while the condition is resolved.
+	-- Must be issued in the E-state just before BRANCH_IF.
+	procedure PREDICT is
+	begin
+		if (BRANCH_PREDICT and i_rom_data(7) = '1') then
+			ROM_READ(br_target);
+			pred_pc <= br_target;
+			pred_spec <= '1';
+		end if;
+	end PREDICT;
+------------------------------------------------------------------
+	-- resolve a conditional relative branch. A correctly predicted branch
+	-- goes straight to execute of the target, a mispredicted one simply
+	-- refetches the fall-through opcode in T0.
+	procedure BRANCH_IF (cond: boolean) is
+	begin
+		pred_spec <= '0';
+		if (cond) then
+			if (pred_spec = '1') then
+				LOAD_IR(pred_pc);
+				trace_taken <= '1';
+				pred_hit <= '1';
+			else
+				BRANCH_TO(br_target);
+			end if;
+		else
+			if (pred_spec = '1') then
+				pred_miss <= '1';
+			end if;
+			cpu_state <= T0;
+			exe_state <= E0;
+		end if;
+	end BRANCH_IF;
+------------------------------------------------------------------
 	
     begin
     if( rst = '1' ) then
@@ -123,16 +350,67 @@ begin
 	ale <= '0'; psen <= '0';
 	mul_a_i <= (others => '0'); mul_b_i <= (others => '0');
 	dividend_i <= (others => '0'); divisor_i <= (others => '1');
+	div_start <= '0'; div_pend <= '0'; div_arm <= '0'; div_wr <= '0'; div_ov <= '0';
 	i_ram_wrByte <= '0'; i_ram_rdByte <= '0'; i_ram_wrBit <= '0'; i_ram_rdBit <= '0';
+	i_ram_ind <= '0';
+	i_ram_bitOp <= BIT_OPC_MOV;
+	i_ram_pair <= '0';
+	i_ram_diHi <= (others => '0');
 	IR <= (others => '0');-- instruction register - where u get the instruction from
 	PC <= (others => '0');-- PC counter, increment 12345678
 	--PC <= "0000000000100111";
 	AR <= (others => '0');
 	DR <= (others => '0');
-	pc_debug <= (others => '1');
+	PSWR <= (others => '0');
+	ir_pc <= (others => '1');
 	int_hold <= '0';
 	erase_flag <= '0';	
+	ir_valid <= '0';
+	br_taken <= '0';
+	instr_retire <= '0';
+	ram_access <= '0';
+	i_rom_rd <= '0';
+	trace_pc <= (others => '0');
+	trace_ir <= (others => '0');
+	trace_taken <= '0';
+	illegal_op <= '0';
+	pred_spec <= '0';
+	pred_pc <= (others => '0');
+	pred_hit <= '0';
+	pred_miss <= '0';
+	pw_valid <= '0';
+	pw_addr <= (others => '0');
+	pw_data <= (others => '0');
+	dptr_inc <= '0';
+	dptr_ld <= '0';
+	dptr_di <= (others => '0');
+	sp_ld <= '0';
+	sp_di <= (others => '0');
     elsif (clk'event and clk = '1') then
+	-- write strobes last one clock, a state only sets them to write. The
+	-- ROM read enable too: int_rom holds its last byte while rd is low.
+	i_ram_wrByte <= '0';
+	i_ram_wrBit <= '0';
+	i_rom_rd <= '0';
+	instr_retire <= '0';
+	ram_access <= '0';
+	illegal_op <= '0';
+	pred_hit <= '0';
+	pred_miss <= '0';
+	dptr_inc <= '0';
+	dptr_ld <= '0';
+	sp_ld <= '0';
+	div_start <= '0';
+	div_arm <= '0';
+	div_wr <= '0';
+	if (div_pend = '1' and div_arm = '0' and div_done = '1') then
+		div_wr <= '1';
+		div_pend <= '0';
+	end if;
+
+	if (cpu_state = T1 and exe_state = E0 and div_hold = '1') then
+		-- wait for the DIV AB result
+	else
     case cpu_state is
 		when T0 => --fetch
 			--get instruction from ROM and load it IR
@@ -140,877 +418,824 @@ begin
 				when E0	=>	--clock cycle 0
 					i_rom_addr <= PC;
 					i_rom_rd <= '1';
+					if (pw_valid = '1') then
+						RAM_WRITE_BYTE(pw_addr);
+						i_ram_diByte <= pw_data;
+						pw_valid <= '0';
+					end if;
 					exe_state <= E1;
 							
 				when E1	=> 	--clock cycle 1
-					-- load instruction add. into IR
-					IR <= i_rom_data;	
-					cpu_state <= T1;
-					PC <= PC + '1';
-					exe_state <= E0;
+					LOAD_IR(PC);
 					
 				when others =>	  
 			end case; -- exe_state 
 
 		when T1 =>   --execute
-			case IR is 
+			case dec_class is
+
+				-- opcodes with their own sequence
+				when CLS_SEQ =>
+					case IR is 
 				
-				-- NOP
-				when "00000000"  =>
-					case exe_state is
-						when E0	=> 
-							
-							exe_state <= E1;
-						
-						when E1	=>
-							exe_state <= E2;
-							
-						when E2	=>						
-							exe_state <= E0;
-							cpu_state <= T0; -- needs to go back to rom and fetch new instruction	
-						when others =>
-					end case;  -- exe_state of NOP
-				--CLR A
-				when "11100100" =>
-					case exe_state is
-						when E0	=>  
-						   i_ram_addr <= xE0;
-							i_ram_diByte <= "00000000";
-							i_ram_wrByte <= '1';
-							exe_state <= E1;
-						
-						when E1	=>
-						   i_ram_wrByte <= '0'; -- reset writebyte to 0
-							exe_state <= E2;
-							
-						when E2	=>						
-							exe_state <= E0;
-							cpu_state <= T0; 
-						when others =>
-					end case;  -- exe_state of CLR A
-				-- MOV A,data
-					when "01110100" =>
-					case exe_state is
-						when E0	=>  
-							i_rom_addr <= PC;
-							i_rom_rd <= '1';
-							exe_state <= E1;
-												
-						when E1	=>
-						   i_ram_diByte <= i_rom_data;
-							i_ram_addr <= xE0;
-							i_ram_wrByte <= '1';
-							exe_state <= E2;
-							
-											
-						when E2	=>		
-							i_ram_wrByte <= '0';	
-							PC <= PC + '1';	
-							i_rom_rd <= '0';	
-							exe_state <= E0;
-							cpu_state <= T0; 
-						when others =>
-					end case;  -- exe_state of MOV A,data
+						--CLR A
+						when "11100100" =>
+							case exe_state is
+								when E0	=>  
+									RAM_WRITE_BYTE(xE0);
+									i_ram_diByte <= "00000000";
+									exe_state <= E0;
+									cpu_state <= T0; 
+								when others =>
+							end case;  -- exe_state of CLR A
 		
-				--INC A
-				when "00000100" =>
-					case exe_state is
-						when E0	=>  
-						   i_ram_addr <= xE0;
-							i_ram_rdByte <='1';
-							exe_state <= E1;
-						
-						when E1	=>
-						   i_ram_rdByte <= '0';
-						   i_ram_diByte <= i_ram_doByte + '1'; 
-						   
-							exe_state <= E2;
-							
-						when E2	=>	
-						   i_ram_wrByte <= '1';	
 					
-							exe_state <= E3;
-						
-						when E3 =>
-            			i_ram_wrByte <= '0'; -- reset writebyte to 0
+						--ACALL addr11
+						when "00010001" | "00110001" | "01010001" | "01110001" | "10010001" | "10110001" | "11010001" | "11110001" =>
+							case exe_state is
+								when E0 =>
+									ROM_READ(PC);  			--read PC(7 downto 0)
+									PC <= PC + '1';
+									exe_state <= E1;
+							
+							  when E1 =>
+									RAM_WRITE_PAIR(sp + '1');	--push PC to sp + 1, sp + 2
+									i_ram_diByte <= PC(7 downto 0);
+									i_ram_diHi <= PC(15 downto 8);
+									sp_ld <= '1';
+									sp_di <= sp + "10";
+									BRANCH_TO(PC(15 downto 11) & IR(7 downto 5) & i_rom_data);	--PC(10 downto 0) <= page address
+							
+							  when others=>
+							end case; --ACALL addr11
 				
-							exe_state <= E0;
-							cpu_state <= T0; 
-						when others =>
-					end case;  -- exe_state of INC A
-					
-				--ACALL addr11
-				when "00010001" | "00110001" | "01010001" | "01110001" | "10010001" | "10110001" | "11010001" | "11110001" =>
-					case exe_state is
-						when E0 =>
-							ROM_READ(PC);  			--read PC(7 downto 0)
-							RAM_READ_BYTE(x81);		--read data in sp
-							exe_state <= E1;
-							
-					  when E1 =>
-							PC <= PC + '1';
-							AR <= i_rom_data;  		-- AR <= PC(7 downto 0) 
-							DR <= i_ram_doByte;     -- sp 
-							exe_state <= E2;
-							
-					  when E2 =>
-							RAM_WRITE_BYTE(DR + '1');	--write PC(7 downto 0) into sp + 1 
-							i_ram_diByte <= PC(7 downto 0);
-							exe_state <= E3;
-							
-					  when E3 =>
-							DR <= DR + '1';
-							DR <= DR + '1';
-							RAM_WRITE_BYTE(DR);	--write PC(15 downto 8) into sp + 2 
-							i_ram_diByte <= PC(15 downto 8);		
-							exe_state <= E4;
-							
-					  when E4 =>
-							DR <= DR + '1';
-							DR <= DR + '1';
-							RAM_WRITE_BYTE(x81);
-							i_ram_diByte <= DR;
-							PC <= PC(15 downto 11) & IR(7 downto 5) & AR;	--PC(10 downto 0) <= page address
-							
-							exe_state <= E0;	
-							cpu_state <= T0;	
-							
-					  when others=>
-					end case; --ACALL addr11
-				
-				--LCALL addr16
-				when "00010010" =>
-					
-					case exe_state is
+						--LCALL addr16
+						when "00010010" =>
 					
-					  when E0 =>
-							PC <= PC + '1';
-							ROM_READ(PC);  	   --read PC(7 downto 0)
-							RAM_READ_BYTE(x81);		--read data in sp
-							PC <= PC + '1';
-							PC <= PC + '1';
-							
-							exe_state <= E1;
-							
-					  when E1 =>
-							PC <= PC - '1';
-							PC <= PC - '1';
-							ROM_READ(PC);			--read PC(15 downto 8)
-							RAM_WRITE_BYTE(i_ram_doByte + '1'); --write (PC + 2)(7 downto 0) to sp+1
-							i_ram_diByte <= PC(7 downto 0);
-							DR <= i_rom_data;  -- write PC(7 downto 0) to dr
-							AR <= i_ram_doByte; -- sp 
-							
-							exe_state <= E2;
-							
-					  when E2 =>
-							AR <= AR + '1';
-							AR <= AR + '1';
-							RAM_WRITE_BYTE(AR);     --write (PC + 2)(15 downto 8) into sp + 2
-							i_ram_diByte <= PC(15 downto 8);
-							PC <= i_rom_data & DR;
-							
-							exe_state <= E3;
-							
-					  when E3 =>
-							AR <= AR + '1';
-							AR <= AR + '1';
-							RAM_WRITE_BYTE(x81);				--write sp + 2 into sp 
-							i_ram_diByte <= AR;		
-							
-							exe_state <= E0;	
-							cpu_state <= T0;	
-							
-					  when others=>
-					end case; --LCALL addr16
-				
-				--RET
-				when "00100010" =>					
-					case exe_state is
+							case exe_state is
 					
-					  when E0 =>
-							RAM_READ_BYTE(x81);		--read data in sp,
-							
-							exe_state <= E1;
+							  when E0 =>
+									ROM_READ(PC);  	   --read addr(15 downto 8)
+									PC <= PC + '1';
 							
-					  when E1 =>
-							RAM_READ_BYTE(i_ram_doByte);
-							DR <= i_ram_doByte;		--addr of top stack
+									exe_state <= E1;
 							
-							exe_state <= E2;
+							  when E1 =>
+									ROM_READ(PC);			--read addr(7 downto 0)
+									PC <= PC + '1';
+									DR <= i_rom_data;
 							
-					  when E2 =>
-							RAM_READ_BYTE(DR - '1');
-							PC(15 downto 8) <= i_ram_doByte;	--pop the top stack
+									exe_state <= E2;
 							
-							exe_state <= E3;
-							
-					  when E3 =>
-							DR <= DR - '1';
-							DR <= DR - '1';
-							RAM_WRITE_BYTE(x81);
-							i_ram_diByte <= DR;	--pop the 2nd of the stack
-							PC(7 downto 0) <= i_ram_doByte;
-							
-							exe_state <= E0;	
-							cpu_state <= T0;	
+							  when E2 =>
+									RAM_WRITE_PAIR(sp + '1');	--push PC to sp + 1, sp + 2
+									i_ram_diByte <= PC(7 downto 0);
+									i_ram_diHi <= PC(15 downto 8);
+									sp_ld <= '1';
+									sp_di <= sp + "10";
+									BRANCH_TO(DR & i_rom_data);
 							
-					  when others=>
-					end case; --RET
+							  when others=>
+							end case; --LCALL addr16
 				
-				--RETI					
-				when "00110010" =>
+						--RET
+						--RETI
+						when "00100010" | "00110010" =>
+							case exe_state is
 					
-					case exe_state is
-					
-					  when E0 =>
-							RAM_READ_BYTE(x81);		--read data in sp
-							
-							exe_state <= E1;
+							  when E0 =>
+									RAM_READ_PAIR(sp - '1');	--pop PC from sp - 1, sp
+									sp_ld <= '1';
+									sp_di <= sp - "10";
 							
-					  when E1 =>
-							RAM_READ_BYTE(i_ram_doByte);
-							DR <= i_ram_doByte;
+									exe_state <= E1;
 							
-							exe_state <= E2;
+							  when E1 =>
+									BRANCH_TO(i_ram_doHi & i_ram_doByte);
 							
-					  when E2 =>
-							RAM_READ_BYTE(DR - '1');	--pop top of stack
-							PC(15 downto 8) <= i_ram_doByte;
-							
-							exe_state <= E3;
-							
-					  when E3 =>
-							DR <= DR - '1';
-							DR <= DR - '1';
-							RAM_WRITE_BYTE(x81);
-							i_ram_diByte <= DR;	--pop 2nd of stack
-							PC(7 downto 0) <= i_ram_doByte;
-							
-							exe_state <= E0;	
-							cpu_state <= T0;	
-							
-					  when others=>
-					end case; --RETI
+							  when others=>
+							end case; --RET, RETI
 				
-				--AJMP addr11				
-				when "00000001" | "00100001" | "01000001" | "01100001" | "10000001" | "10100001" | "11000001" | "11100001" =>
-					case exe_state is
+						--AJMP addr11				
+						when "00000001" | "00100001" | "01000001" | "01100001" | "10000001" | "10100001" | "11000001" | "11100001" =>
+							case exe_state is
 					
-						when E0 =>
-							ROM_READ(PC);
+								when E0 =>
+									ROM_READ(PC);
+									PC <= PC + '1';
 							
-							exe_state <= E1;
-							
-						when E1 =>
-							PC <= PC + '1';
-							AR <= i_rom_data;
-							
-							exe_state <= E2;
-							
-						when E2 =>
-							PC <= PC(15 downto 11) & IR(7 downto 5) & AR;	--(PC10-0) <- page address
+									exe_state <= E1;
 							
-							exe_state <= E0;	
-							cpu_state <= T0;	
+								when E1 =>
+									BRANCH_TO(PC(15 downto 11) & IR(7 downto 5) & i_rom_data);	--(PC10-0) <- page address
 							
-						when others=>
-					end case; --AJMP addr11
+								when others=>
+							end case; --AJMP addr11
 				
-				--LJMP addr16				
-				when "00000010" =>
+						--LJMP addr16				
+						when "00000010" =>
 					
-					case exe_state is
+							case exe_state is
 					
-						when E0 =>
-							ROM_READ(PC);
+								when E0 =>
+									ROM_READ(PC);
 							
-							exe_state <= E1;
+									exe_state <= E1;
 							
-						when E1 =>
-							ROM_READ(PC + '1');
-							AR <= i_rom_data;
+								when E1 =>
+									ROM_READ(PC + '1');
+									AR <= i_rom_data;
 							
-							exe_state <= E2;
+									exe_state <= E2;
 							
-						when E2 =>
-							PC <= AR & i_rom_data;  
+								when E2 =>
+									BRANCH_TO(AR & i_rom_data);
 							
-							exe_state <= E0;	
-							cpu_state <= T0;	
-							
-						when others=>
-					end case; --LJMP addr16
+								when others=>
+							end case; --LJMP addr16
 				
-				--SJMP rel
-				when "10000000" =>
+						--SJMP rel
+						when "10000000" =>
 					
-					case exe_state is
+							case exe_state is
 					
-						when E0 =>
-							ROM_READ(PC);
-							
-							exe_state <= E1;
+								when E0 =>
+									ROM_READ(PC);
+									PC <= PC + '1';
 							
-						when E1 => 
+									exe_state <= E1;
 							
-							if i_rom_data(7) = '1' then
-								alu_src_2L <= PC(7 downto 0);
-								alu_src_2H <= PC(15 downto 8);	
-								alu_src_1L <= i_rom_data;
-								alu_src_1H <= "11111111";	
-								alu_op_code <= ALU_OPC_ADD;
-								alu_cy_bw <= '0';
-								alu_by_wd <= '1';
-							
-							else
-								alu_src_2L <= PC(7 downto 0);
-								alu_src_2H <= PC(15 downto 8);	
-								alu_src_1L <= i_rom_data;
-								alu_src_1H <= "00000000";	
-								alu_op_code <= ALU_OPC_ADD;
-								alu_cy_bw <= '0';
-								alu_by_wd <= '1';
-								
-							end if;
+								when E1 =>
+									BRANCH_TO(br_target);
 							
-							exe_state <= E2;
-							
-						when E2 =>
-						   PC <= alu_ans_H & alu_ans_L;
-							
-							exe_state <= E3;
-							
-						when E3 =>
-						   PC <= PC + '1';
-							
-							exe_state <= E0;	
-							cpu_state <= T0;	
-							
-						when others=>
-					end case; --SJMP rel
+								when others=>
+							end case; --SJMP rel
 				
-				--JMP @A + DPTR	
-				when "01110011"  =>
-					case exe_state is
+						--JMP @A + DPTR	
+						when "01110011"  =>
+							case exe_state is
 					
-						when E0 =>
-							RAM_READ_BYTE(x83); --read dph
+								when E0 =>
+									RAM_READ_BYTE(xE0); --read acc
 							
-							exe_state <= E1;
-							
-						when E1 =>
-							DR <= i_ram_doByte;
-							RAM_READ_BYTE(x82); --read dpl
+									exe_state <= E1;
 							
-							exe_state <= E2;
-							
-						when E2 =>
-						   AR <= i_ram_doByte;
-							RAM_READ_BYTE(xE0); --read acc
-								
-							exe_state <= E3;
+								when E1 =>
+									alu_src_2L <= dptr(7 downto 0);
+									alu_src_2H <= dptr(15 downto 8);	
+									alu_src_1L <= i_ram_doByte;
+									alu_src_1H <= "00000000";	
+									alu_op_code <= ALU_OPC_ADD;
+									alu_cy_bw <= '0';
+									alu_by_wd <= '1';
 							
-						when E3 =>
-							alu_src_2L <= AR;
-							alu_src_2H <= DR;	
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_ADD;
-							alu_cy_bw <= '0';
-							alu_by_wd <= '1';
+									exe_state <= E2;
 							
-							exe_state <= E4;
+								when E2 =>
+									BRANCH_TO(alu_ans_H & alu_ans_L);
 							
-						when E4 =>
-							PC <= alu_ans_H & alu_ans_L;
-												
-							exe_state <= E0;	
-							cpu_state <= T0;	
-							
-						when others=>					
-					end case; --JMP @A + DPTR
+								when others=>					
+							end case; --JMP @A + DPTR
 				
-				--JZ rel
-				WHEN "01100000" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							RAM_READ_BYTE(XE0);	--read in acc
-							PC <= PC + '1';
-									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							if( I_RAM_DOBYTE = "00000000" ) then	--check in acc is 0
-                                if(i_rom_data(7) = '0') then
-									PC <= PC + i_rom_data(6 downto 0);
-								else 
-									PC <= PC - not(i_rom_data(6 downto 0)) - 1;	--negative so convert to 1 complement
-								end if;
-                            end if;	
+						--JZ rel
+						WHEN "01100000" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									RAM_READ_BYTE(XE0);	--read in acc
+									PC <= PC + '1';
 									
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
-						WHEN OTHERS	=>
-				END CASE;	--jz rel
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									BRANCH_IF(I_RAM_DOBYTE = "00000000");
+								WHEN OTHERS	=>
+						END CASE;	--jz rel
 				
-				--JNZ rel			--ZhenYong, Tested and simulated.
-				WHEN "01110000" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							RAM_READ_BYTE(XE0);
-							PC <= PC + '1';
+						--JNZ rel			--ZhenYong, Tested and simulated.
+						WHEN "01110000" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									RAM_READ_BYTE(XE0);
+									PC <= PC + '1';
 									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							if( I_RAM_DOBYTE /= "00000000" ) then
-                                if(i_rom_data(7) = '0') then
-									PC <= PC + i_rom_data(6 downto 0);
-								else 
-									PC <= PC - not(i_rom_data(6 downto 0)) - 1;
-								end if;
-                            end if;	
-									
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
-						WHEN OTHERS	=>
-					END CASE;	--jnz rel
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									BRANCH_IF(I_RAM_DOBYTE /= "00000000");
+								WHEN OTHERS	=>
+							END CASE;	--jnz rel
 				
-				--CJNE A,direct,rel
-				WHEN "10110101" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							RAM_READ_BYTE(XE0);
-							PC <= PC + '1';
+						--CJNE A,direct,rel
+						WHEN "10110101" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									RAM_READ_BYTE(XE0);
+									PC <= PC + '1';
 									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							DR <= I_RAM_DOBYTE; --ACC
-							ROM_READ(PC);
-							RAM_READ_BYTE(i_rom_data);--direct addressed data
-							PC <= PC + '1';
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									DR <= I_RAM_DOBYTE; --ACC
+									ROM_READ(PC);
+									RAM_READ_BYTE(i_rom_data);--direct addressed data
+									PC <= PC + '1';
 									
-							EXE_STATE <= E2;
-						WHEN E2	=>
-							RAM_READ_BYTE(XD0); --read psw
-							if( I_RAM_DOBYTE /= DR ) then
-								if(i_rom_data(7) = '0') then
-									PC <= PC + i_rom_data(6 downto 0);
-								else 
-									PC <= PC - not(i_rom_data(6 downto 0)) - 1;
-								end if;
-                            end if;
+									EXE_STATE <= E2;
+								WHEN E2	=>
+									if( DR < I_RAM_DOBYTE ) then
+										RAM_RMW_BIT(xD7, BIT_OPC_SET);
+									else
+										RAM_RMW_BIT(xD7, BIT_OPC_CLR);
+									end if;
 									
-							EXE_STATE <= E3;
-						WHEN E3	=>
-							
-							if( DR < I_RAM_DOBYTE ) then
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '1' & I_RAM_DOBYTE(6 downto 0);
-							else
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '0' & I_RAM_DOBYTE(6 downto 0);
-							end if;
-							
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
+									BRANCH_IF(I_RAM_DOBYTE /= DR);
 						
-						WHEN OTHERS	=>
-					END CASE;		--CJNE A,direct,rel
+								WHEN OTHERS	=>
+							END CASE;		--CJNE A,direct,rel
 					
-				--CJNE A,#data,rel
-				WHEN "10110100" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							RAM_READ_BYTE(XD0); --PSW
-							PC <= PC + '1';
+						--CJNE A,#data,rel
+						WHEN "10110100" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									RAM_READ_BYTE(XE0); --ACC
+									PC <= PC + '1';
 									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							AR <= I_RAM_DOBYTE; --PSW
-							DR <= i_rom_data; --#data
-							RAM_READ_BYTE(XE0); --ACC
-							ROM_READ(PC);
-							PC <= PC + '1';
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									DR <= i_rom_data; --#data
+									ROM_READ(PC);
+									PC <= PC + '1';
 									
-							EXE_STATE <= E2;
-						WHEN E2	=>
-							if( DR /= I_RAM_DOBYTE ) then
-								if(i_rom_data(7) = '0') then
-									PC <= PC + i_rom_data(6 downto 0);
-								else 
-									PC <= PC - not(i_rom_data(6 downto 0)) - 1;
-								end if;
-                            end if;
+									EXE_STATE <= E2;
+								WHEN E2	=>
+									if( I_RAM_DOBYTE < DR ) then
+										RAM_RMW_BIT(xD7, BIT_OPC_SET);
+									else
+										RAM_RMW_BIT(xD7, BIT_OPC_CLR);
+									end if;
 									
-							EXE_STATE <= E3;
-						WHEN E3	=>
-							
-							if( I_RAM_DOBYTE < DR ) then
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '1' & AR(6 downto 0);
-							else
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '0' & AR(6 downto 0);
-							end if;
-		
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
+									BRANCH_IF(DR /= I_RAM_DOBYTE);
 						
-						WHEN OTHERS	=>
-					END CASE;	--CJNE A,#data,rel
+								WHEN OTHERS	=>
+							END CASE;	--CJNE A,#data,rel
 					
-				--CJNE Rn,#data,rel
-				WHEN "10111000" | "10111001" | "10111010" | "10111011" | "10111100" | "10111101" | "10111110" | "10111111" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							RAM_READ_BYTE(XD0); --PSW
-							PC <= PC + '1';
+						--CJNE Rn,#data,rel
+						WHEN "10111000" | "10111001" | "10111010" | "10111011" | "10111100" | "10111101" | "10111110" | "10111111" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									RAM_READ_BYTE(XD0); --PSW
+									PC <= PC + '1';
 									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							AR <= I_RAM_DOBYTE; --PSW
-							DR <= i_rom_data; --#data
-							RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) &  IR(2 downto 0)); --@Ri
-							ROM_READ(PC);
-							PC <= PC + '1';
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									DR <= i_rom_data; --#data
+									RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) &  IR(2 downto 0)); --Rn
+									ROM_READ(PC);
+									PC <= PC + '1';
 									
-							EXE_STATE <= E2;
-						WHEN E2	=>
-							if( DR /= I_RAM_DOBYTE ) then
-								if(i_rom_data(7) = '0') then
-									PC <= PC + i_rom_data(6 downto 0);
-								else 
-									PC <= PC - not(i_rom_data(6 downto 0)) - 1;	--negative
-								end if;
-                            end if;
+									EXE_STATE <= E2;
+								WHEN E2	=>
+									if( I_RAM_DOBYTE < DR ) then
+										RAM_RMW_BIT(xD7, BIT_OPC_SET);
+									else
+										RAM_RMW_BIT(xD7, BIT_OPC_CLR);
+									end if;
 									
-							EXE_STATE <= E3;
-						WHEN E3	=>
-							
-							if( I_RAM_DOBYTE < DR ) then
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '1' & AR(6 downto 0);
-							else
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '0' & AR(6 downto 0);
-							end if;
-							
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
+									BRANCH_IF(DR /= I_RAM_DOBYTE);
 						
-						WHEN OTHERS	=>
-					END CASE;	--CJNE Rn,#data,rel
+								WHEN OTHERS	=>
+							END CASE;	--CJNE Rn,#data,rel
 					
-				--CJNE @Ri,#data,rel
-				WHEN "10110110" | "10110111" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							RAM_READ_BYTE(XD0); --PSW
-							PC <= PC + '1';
+						--CJNE @Ri,#data,rel
+						WHEN "10110110" | "10110111" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									RAM_READ_BYTE(XD0); --PSW
+									PC <= PC + '1';
 									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							AR <= I_RAM_DOBYTE; --PSW
-							DR <= i_rom_data; --#data
-							RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & "00" & IR(0)); --@Ri
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									DR <= i_rom_data; --#data
+									RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & "00" & IR(0)); --@Ri
+									ROM_READ(PC);	--rel
+									PC <= PC + '1';
 									
-							EXE_STATE <= E2;
+									EXE_STATE <= E2;
 						
-						WHEN E2 =>
-							RAM_READ_BYTE(I_RAM_DOBYTE);
-							ROM_READ(PC);
-							PC <= PC + '1';
-							
-							EXE_STATE <= E3;
-							
-						WHEN E3	=>
-							if( DR /= I_RAM_DOBYTE ) then
-								if(i_rom_data(7) = '0') then
-									PC <= PC + i_rom_data(6 downto 0);
-								else 
-									PC <= PC - not(i_rom_data(6 downto 0)) - 1;	--negative
-								end if;
-                            end if;
+								WHEN E2 =>
+									RAM_READ_IDATA(I_RAM_DOBYTE);
+									PREDICT;
+							
+									EXE_STATE <= E3;
+							
+								WHEN E3	=>
+									if( I_RAM_DOBYTE < DR ) then
+										RAM_RMW_BIT(xD7, BIT_OPC_SET);
+									else
+										RAM_RMW_BIT(xD7, BIT_OPC_CLR);
+									end if;
 									
-							EXE_STATE <= E4;
-						WHEN E4	=>
-							
-							if( I_RAM_DOBYTE < DR ) then
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '1' & AR(6 downto 0);
-							else
-								RAM_WRITE_BYTE(xD0);
-								i_ram_diByte <= '0' & AR(6 downto 0);
-							end if;
-							
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
+									BRANCH_IF(DR /= I_RAM_DOBYTE);
 						
-						WHEN OTHERS	=>
-					END CASE;	--CJNE @Ri,#data,rel
+								WHEN OTHERS	=>
+							END CASE;	--CJNE @Ri,#data,rel
 					
-				--DJNZ Rn,rel
-				WHEN "11011000" | "11011001" | "11011010" | "11011011" | "11011100" | "11011101" | "11011110" | "11011111" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							RAM_READ_BYTE(XD0); --PSW
-							PC <= PC + '1';
+						--DJNZ Rn,rel
+						WHEN "11011000" | "11011001" | "11011010" | "11011011" | "11011100" | "11011101" | "11011110" | "11011111" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									RAM_READ_BYTE(XD0); --PSW
+									PC <= PC + '1';
 									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							DR <= i_rom_data; --rel
-							RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & IR(2 downto 0)); --Rn
-							AR <= "000" & i_ram_doByte(4 downto 3) & IR(2 downto 0);
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & IR(2 downto 0)); --Rn
+									AR <= "000" & i_ram_doByte(4 downto 3) & IR(2 downto 0);
 									
-							EXE_STATE <= E2;
-						when E2	=>
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_DEC;	
-							alu_by_wd <= BYTE;
-							
-							exe_state <= E3;
-						WHEN E3	=>
-							if( alu_ans_L /= "00000000" ) then
-								if(DR(7) = '0') then
-									PC <= PC + DR(6 downto 0);
-								else 
-									PC <= PC - not(DR(6 downto 0)) - 1;	--negative
-								end if;
-                            end if;
-							
-							i_ram_diByte <= alu_ans_L;
-							RAM_WRITE_BYTE(AR);
-
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
-
-						WHEN OTHERS	=>
-					END CASE;	--DJNZ Rn,rel
+									EXE_STATE <= E2;
+								when E2	=>
+									alu_src_1L <= i_ram_doByte;
+									alu_src_1H <= "00000000";	
+									alu_op_code <= ALU_OPC_DEC;	
+									alu_by_wd <= BYTE;
+									PREDICT;
+							
+									exe_state <= E3;
+								WHEN E3	=>
+									i_ram_diByte <= alu_ans_L;
+									RAM_WRITE_BYTE(AR);
+									
+									BRANCH_IF(alu_ans_L /= "00000000");
+
+								WHEN OTHERS	=>
+							END CASE;	--DJNZ Rn,rel
 					
-				--DJNZ direct,rel
-				WHEN "11010101" =>
-					CASE EXE_STATE IS
-						WHEN E0	=>
-							ROM_READ(PC);
-							PC <= PC + '1';
+						--DJNZ direct,rel
+						WHEN "11010101" =>
+							CASE EXE_STATE IS
+								WHEN E0	=>
+									ROM_READ(PC);
+									PC <= PC + '1';
 									
-							EXE_STATE <= E1;
-						WHEN E1	=>
-							ROM_READ(PC);
-							PC <= PC + '1';
-							RAM_READ_BYTE(i_rom_data); --dir
-							AR <= i_rom_data;
+									EXE_STATE <= E1;
+								WHEN E1	=>
+									ROM_READ(PC);
+									PC <= PC + '1';
+									RAM_READ_BYTE(i_rom_data); --dir
+									AR <= i_rom_data;
 									
-							EXE_STATE <= E2;
-						when E2	=>
-							DR <= i_rom_data; --rel
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_DEC;	
-							alu_by_wd <= BYTE;
-							exe_state <= E3;
-						WHEN E3	=>
-							if( alu_ans_L /= "00000000" ) then
-								if(DR(7) = '0') then
-									PC <= PC + DR(6 downto 0);
-								else 
-									PC <= PC - not(DR(6 downto 0)) - 1;	--negative
-								end if;
-                            end if;
-							
-							i_ram_diByte <= alu_ans_L;
-							RAM_WRITE_BYTE(AR);
-							
-							CPU_STATE <= T0;
-							EXE_STATE <= E0;
+									EXE_STATE <= E2;
+								when E2	=>
+									alu_src_1L <= i_ram_doByte;
+									alu_src_1H <= "00000000";	
+									alu_op_code <= ALU_OPC_DEC;	
+									alu_by_wd <= BYTE;
+									PREDICT;
+									exe_state <= E3;
+								WHEN E3	=>
+									i_ram_diByte <= alu_ans_L;
+									RAM_WRITE_BYTE(AR);
+									
+									BRANCH_IF(alu_ans_L /= "00000000");
 						
-						WHEN OTHERS	=>
-					END CASE;	--DJNZ direct,rel
+								WHEN OTHERS	=>
+							END CASE;	--DJNZ direct,rel
 					
-				-- INC Rn
-				when "00001000" | "00001001" | "00001010" | "00001011" | "00001100" | "00001101" | "00001110" | "00001111" =>
-					case exe_state is
-						when E0	=>
-							RAM_READ_BYTE(xD0);	--psw
+				
+				
+				
+						-- INC DPTR
+						when "10100011" =>
+							case exe_state is
+								when E0	=>
+									RAM_IDLE;
+									dptr_inc <= '1';
 									
-							exe_state <= E1;
-						when E1	=>
-							AR <= "000" & i_ram_doByte(4 downto 3) & IR(2 downto 0);
-							RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & IR(2 downto 0));
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	---- INC DPTR
+					
+						-- MOV DPTR,#data16
+						when "10010000" =>
+							case exe_state is
+								when E0	=>
+									ROM_READ(PC);
+									PC <= PC + '1';
 									
-							exe_state <= E2;
-						when E2	=>	
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_INC;	
-							alu_by_wd <= BYTE;
-							
-							exe_state <= E3;
-						when E3	=>
-							RAM_WRITE_BYTE(AR);
-							i_ram_diByte <= alu_ans_L;	
-							
-							cpu_state <= T0;
-							exe_state <= E0;
-						when others	=>
-					end case;	--inc rn
-				
-				-- INC direct
-				when "00000101" =>
-					case exe_state is
-						when E0	=>
-							ROM_READ(PC);
-							PC <= PC + '1';
+									exe_state <= E1;
+								when E1	=>
+									DR <= i_rom_data;	--high byte first
+									ROM_READ(PC);
+									PC <= PC + '1';
 									
-							exe_state <= E1;
-						when E1	=>
-							RAM_READ_BYTE(i_rom_data);
-							AR <= i_rom_data;
+									exe_state <= E2;
+								when E2	=>
+									RAM_IDLE;
+									dptr_ld <= '1';
+									dptr_di <= DR & i_rom_data;
 									
-							exe_state <= E2;
-						when E2	=>
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_INC;
-							alu_by_wd <= BYTE;
-							
-							exe_state <= E3;
-						when E3	=>
-							RAM_WRITE_BYTE(AR);
-							i_ram_diByte <= alu_ans_L;	
-							
-							cpu_state <= T0;
-							exe_state <= E0;
-						when others	=>
-					end case;	--inc direct
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	--mov dptr,#data16
+					
 				
-				-- INC @Ri
-				when "00000110" | "00000111" =>
-					case exe_state is
-						when E0	=>
-							RAM_READ_BYTE(xD0);	--psw
+						-- 16 bit operations, A5h prefix. The second byte selects one
+						-- word pass of the ALU, Wp is the pair R(2p+1):R(2p) of the
+						-- current bank (high:low).
+						--   24 hi lo	ADD DPTR,#data16	CY/AC/OV from bit 15/7/15
+						--   94 hi lo	SUB DPTR,#data16
+						--   28+p		ADD DPTR,Wp
+						--   98+p		SUB DPTR,Wp
+						--   08+p		INC Wp
+						--   18+p		DEC Wp
+						--   14		DEC DPTR
+						when "10100101" =>
+							case exe_state is
+								when E0	=>
+									ROM_READ(PC);			--16 bit opcode
+									PC <= PC + '1';
+									RAM_READ_BYTE(xD0);	--psw: register bank, flags
 									
-							exe_state <= E1;
-						when E1	=>
-							RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & "00" & IR(0));
+									exe_state <= E1;
+								when E1	=>
+									PSWR <= i_ram_doByte;
+									DR <= i_rom_data;
+									case i_rom_data is
+										when "00100100" | "10010100" =>	--#data16, high byte first
+											ROM_READ(PC);
+											PC <= PC + '1';
+											exe_state <= E2;
+										when "00010100" =>
+											exe_state <= E3;
+										when "00001000" | "00001001" | "00001010" | "00001011" |
+											 "00011000" | "00011001" | "00011010" | "00011011" |
+											 "00101000" | "00101001" | "00101010" | "00101011" |
+											 "10011000" | "10011001" | "10011010" | "10011011" =>
+											AR <= "000" & i_ram_doByte(4 downto 3) & i_rom_data(1 downto 0) & '0';
+											RAM_READ_PAIR("000" & i_ram_doByte(4 downto 3) & i_rom_data(1 downto 0) & '0');
+											exe_state <= E3;
+										when others =>
+											illegal_op <= '1';
+											cpu_state <= T0;
+											exe_state <= E0;
+									end case;
+								when E2	=>
+									AR <= i_rom_data;
+									ROM_READ(PC);
+									PC <= PC + '1';
 									
-							exe_state <= E2;
-						
-						when E2 =>
-							AR <= i_ram_doByte;
-							RAM_READ_BYTE(i_ram_doByte);
-							
-							exe_state <= E3;
+									exe_state <= E3;
+								when E3	=>
+									if (DR(7) = '0' and DR(5) = '0' and DR(3) = '1') then	--INC/DEC Wp
+										alu_src_1L <= i_ram_doByte;
+										alu_src_1H <= i_ram_doHi;
+									else
+										alu_src_1L <= dptr(7 downto 0);
+										alu_src_1H <= dptr(15 downto 8);
+									end if;
+									if (DR(3) = '1') then
+										alu_src_2L <= i_ram_doByte;
+										alu_src_2H <= i_ram_doHi;
+									else
+										alu_src_2L <= i_rom_data;
+										alu_src_2H <= AR;
+									end if;
+									case DR(7 downto 4) is
+										when "0000" =>	alu_op_code <= ALU_OPC_INC;
+										when "0001" =>	alu_op_code <= ALU_OPC_DEC;
+										when "0010" =>	alu_op_code <= ALU_OPC_ADD;
+										when others =>	alu_op_code <= ALU_OPC_SUB;
+									end case;
+									alu_cy_bw <= '0';
+									alu_by_wd <= WORD;
 									
-						when E3	=>
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_INC;	
-							alu_by_wd <= BYTE;
-							
-							exe_state <= E4;
-						when E4	=>
-							RAM_WRITE_BYTE(AR);
-							i_ram_diByte <= alu_ans_L;	
-							
-							cpu_state <= T0;
-							exe_state <= E0;
-						when others	=>
-					end case;	-- INC @Ri
+									exe_state <= E4;
+								when E4	=>
+									if (DR(7) = '0' and DR(5) = '0' and DR(3) = '1') then
+										RAM_WRITE_PAIR(AR);
+										i_ram_diByte <= alu_ans_L;
+										i_ram_diHi <= alu_ans_H;
+									else
+										RAM_IDLE;
+										dptr_ld <= '1';
+										dptr_di <= alu_ans_H & alu_ans_L;
+									end if;
+									if (DR(7) = '1' or DR(5) = '1') then	--ADD/SUB
+										RAM_POST_BYTE(xD0, alu_cy & alu_ac & PSWR(5 downto 3) & alu_ov & PSWR(1 downto 0));
+									end if;
+									
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	--16 bit operations
 				
-				-- INC DPTR
-				when "10100011" =>
-					case exe_state is
-						when E0	=>
-							RAM_READ_BYTE(x82);	--dpl
+						-- DIV AB
+						when "10000100" =>
+							case exe_state is
+								when E0	=>
+									RAM_READ_BYTE(xE0);	--A
 									
-							exe_state <= E1;					
-						when E1	=>	
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_INC;	
-							alu_by_wd <= BYTE;
-							
-							RAM_READ_BYTE(x83);	--dph
-							exe_state <= E2;
-						when E2	=>	
-							RAM_WRITE_BYTE(x82);
-							i_ram_diByte <= alu_ans_L;
-							
-							alu_src_1L <= i_ram_doByte;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_INC;
-							alu_by_wd <= BYTE;
-							
-							exe_state <= E3;	
-						when E3	=>
-							RAM_WRITE_BYTE(x83);
-							i_ram_diByte <= alu_ans_L;	
-							
+									exe_state <= E1;
+								when E1	=>
+									DR <= i_ram_doByte;
+									RAM_READ_BYTE(xF0);	--B
+									
+									exe_state <= E2;
+								when E2	=>
+									dividend_i <= "00000000" & DR;
+									divisor_i <= "00000000" & i_ram_doByte;
+									div_start <= '1';
+									div_arm <= '1';
+									div_pend <= '1';
+									if (i_ram_doByte = "00000000") then
+										div_ov <= '1';
+									else
+										div_ov <= '0';
+									end if;
+									
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	--div ab
+				
+						-- CLR C / SETB C / CPL C
+						when "11000011" | "11010011" | "10110011" =>
+							case exe_state is
+								when E0	=>
+									if (IR(6) = '0') then
+										RAM_RMW_BIT(xD7, BIT_OPC_CPL);
+									elsif (IR(4) = '0') then
+										RAM_RMW_BIT(xD7, BIT_OPC_CLR);
+									else
+										RAM_RMW_BIT(xD7, BIT_OPC_SET);
+									end if;
+							
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	--clr/setb/cpl c
+				
+						-- CLR bit / SETB bit / CPL bit
+						when "11000010" | "11010010" | "10110010" =>
+							case exe_state is
+								when E0	=>
+									ROM_READ(PC);
+									PC <= PC + '1';
+							
+									exe_state <= E1;
+								when E1	=>
+									if (IR(6) = '0') then
+										RAM_RMW_BIT(i_rom_data, BIT_OPC_CPL);
+									elsif (IR(4) = '0') then
+										RAM_RMW_BIT(i_rom_data, BIT_OPC_CLR);
+									else
+										RAM_RMW_BIT(i_rom_data, BIT_OPC_SET);
+									end if;
+							
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	--clr/setb/cpl bit
+				
+						-- JBC bit,rel
+						when "00010000" =>
+							case exe_state is
+								when E0	=>
+									ROM_READ(PC);
+									PC <= PC + '1';
+							
+									exe_state <= E1;
+								when E1	=>
+									RAM_RMW_BIT(i_rom_data, BIT_OPC_CLR);	--test and clear
+									ROM_READ(PC);
+									PC <= PC + '1';
+							
+									exe_state <= E2;
+								when E2	=>
+									BRANCH_IF(i_ram_doBit = '1');
+								when others	=>
+							end case;	--jbc bit,rel
+				
+						-- MOV C,bit
+						when "10100010" =>
+							case exe_state is
+								when E0	=>
+									ROM_READ(PC);
+									PC <= PC + '1';
+							
+									exe_state <= E1;
+								when E1	=>
+									RAM_READ_BIT(i_rom_data);
+							
+									exe_state <= E2;
+								when E2	=>
+									RAM_WRITE_BIT(xD7);
+									i_ram_diBit <= i_ram_doBit;
+							
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	--mov c,bit
+				
+						-- MOV bit,C
+						when "10010010" =>
+							case exe_state is
+								when E0	=>
+									ROM_READ(PC);
+									PC <= PC + '1';
+									RAM_READ_BIT(xD7);
+							
+									exe_state <= E1;
+								when E1	=>
+									RAM_WRITE_BIT(i_rom_data);
+									i_ram_diBit <= i_ram_doBit;
+							
+									cpu_state <= T0;
+									exe_state <= E0;
+								when others	=>
+							end case;	--mov bit,c
+	
+
+
+
+					when others => 		
+							exe_state <= E0;	
 							cpu_state <= T0;
-							exe_state <= E0;
-						when others	=>
-					end case;	---- INC DPTR
-					
-				-- ADD A,Rn swetha
-				when "00101000" | "00101001" | "00101010" | "00101011" | "00101100" | "00101101" | "00101110" | "00101111" =>
+					end case; -- IR
+
+				-- NOP
+				when CLS_NOP =>
+					exe_state <= E0;
+					cpu_state <= T0;
+
+				-- table driven MOV, ALU and INC/DEC. E0..E2 fetch the source
+				-- operand for every mode, it is valid in E3 (AR holds its address).
+				when CLS_MOV | CLS_ALU | CLS_UNARY =>
 					case exe_state is
 						when E0	=>
-							RAM_READ_BYTE(xD0);
-							
+							RAM_READ_BYTE(xD0);	--psw: register bank, carry
+							if (dec_src = AM_DIR or dec_src = AM_IMM or dec_dst = AM_DIR) then
+								ROM_READ(PC);
+								PC <= PC + '1';
+							end if;
+
 							exe_state <= E1;
-						when E1	=>		
-							AR <= i_ram_doByte;--put PSW into AR
-							RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & IR(2 downto 0));
-							
-							exe_state <= E2;
+						when E1	=>
+							PSWR <= i_ram_doByte;
+							case dec_src is
+								when AM_ACC =>
+									AR <= xE0;
+									RAM_READ_BYTE(xE0);
+									exe_state <= E3;
+								when AM_RN =>
+									AR <= "000" & i_ram_doByte(4 downto 3) & IR(2 downto 0);
+									RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & IR(2 downto 0));
+									exe_state <= E3;
+								when AM_DIR =>
+									AR <= i_rom_data;
+									RAM_READ_BYTE(i_rom_data);
+									if (dec_dst = AM_DIR) then	--MOV direct,direct: destination is the 2nd byte
+										ROM_READ(PC);
+										PC <= PC + '1';
+									end if;
+									exe_state <= E3;
+								when AM_IND =>
+									RAM_READ_BYTE("000" & i_ram_doByte(4 downto 3) & "00" & IR(0));
+									exe_state <= E2;
+								when others =>	--#data
+									if (dec_dst = AM_DIR) then	--direct,#data: destination is the 1st byte
+										AR <= i_rom_data;
+										ROM_READ(PC);
+										PC <= PC + '1';
+									end if;
+									exe_state <= E3;
+							end case;
 						when E2	=>
-							DR <= i_ram_doByte;
-							RAM_READ_BYTE(xE0);
-								
+							AR <= i_ram_doByte;
+							RAM_READ_IDATA(i_ram_doByte);	--@Ri
+
 							exe_state <= E3;
-						when E3	=>
-							alu_src_2L <= i_ram_doByte;
-							alu_src_2H <= "00000000";	
-							alu_src_1L <= DR;
-							alu_src_1H <= "00000000";	
-							alu_op_code <= ALU_OPC_ADD;
-							alu_by_wd <= BYTE;
-							alu_cy_bw <= '0';
-							
-							exe_state <= E4;
-						when E4	=>
-							RAM_WRITE_BYTE(xE0);
-							i_ram_diByte <= alu_ans_L;	
-							
-							exe_state <= E5;
-						when E5	=>
-							
-							RAM_WRITE_BYTE(xD0);
-							i_ram_diByte <= alu_cy & alu_ac & AR(5 downto 3) & alu_ov & AR(1 downto 0);
-							
-							cpu_state <= T0;
-							exe_state <= E0;
 						when others	=>
-					end case;	--add a, rn
-	
+							if (dec_src = AM_IMM) then
+								opnd := i_rom_data;
+							else
+								opnd := i_ram_doByte;
+							end if;
+
+							case dec_dst is
+								when AM_ACC =>
+									dst := xE0;
+								when AM_RN =>
+									dst := "000" & PSWR(4 downto 3) & IR(2 downto 0);
+								when AM_DIR =>
+									if (dec_src = AM_IMM) then
+										dst := AR;
+									else
+										dst := i_rom_data;
+									end if;
+								when others =>
+									dst := AR;
+							end case;
 
+							case dec_class is
+								when CLS_MOV =>
+									case exe_state is
+										when E3	=>
+											if (dec_dst = AM_IND) then
+												DR <= opnd;
+												RAM_READ_BYTE("000" & PSWR(4 downto 3) & "00" & IR(0));
+												exe_state <= E4;
+											else
+												RAM_WRITE_BYTE(dst);
+												i_ram_diByte <= opnd;
+												cpu_state <= T0;
+												exe_state <= E0;
+											end if;
+										when others	=>
+											RAM_WRITE_IDATA(i_ram_doByte);	--@Ri
+											i_ram_diByte <= DR;
+											cpu_state <= T0;
+											exe_state <= E0;
+									end case;
 
+								when CLS_ALU =>
+									case exe_state is
+										when E3	=>
+											DR <= opnd;
+											AR <= dst;
+											RAM_READ_BYTE(dst);
 
-			when others => 		
-					exe_state <= E0;	
+											exe_state <= E4;
+										when E4	=>
+											alu_src_1L <= i_ram_doByte;
+											alu_src_1H <= "00000000";
+											alu_src_2L <= DR;
+											alu_src_2H <= "00000000";
+											alu_op_code <= dec_alu;
+											alu_cy_bw <= PSWR(7);
+											alu_by_wd <= BYTE;
+
+											exe_state <= E5;
+										when E5	=>
+											RAM_WRITE_BYTE(AR);
+											i_ram_diByte <= alu_ans_L;
+											if (dec_flags = FL_ALL) then
+												RAM_POST_BYTE(xD0, alu_cy & alu_ac & PSWR(5 downto 3) & alu_ov & PSWR(1 downto 0));
+											elsif (dec_flags = FL_CY) then
+												RAM_POST_BYTE(xD0, alu_cy & PSWR(6 downto 0));
+											end if;
+
+											cpu_state <= T0;
+											exe_state <= E0;
+										when others	=>
+									end case;
+
+								when others	=>	--CLS_UNARY, the result goes back to the source
+									case exe_state is
+										when E3	=>
+											alu_src_1L <= opnd;
+											alu_src_1H <= "00000000";
+											alu_op_code <= dec_alu;
+											alu_cy_bw <= PSWR(7);
+											alu_ac_in <= PSWR(6);
+											alu_by_wd <= BYTE;
+
+											exe_state <= E4;
+										when E4	=>
+											if (dec_src = AM_IND) then
+												RAM_WRITE_IDATA(AR);
+											else
+												RAM_WRITE_BYTE(AR);
+											end if;
+											i_ram_diByte <= alu_ans_L;
+											if (dec_flags = FL_ALL) then
+												RAM_POST_BYTE(xD0, alu_cy & alu_ac & PSWR(5 downto 3) & alu_ov & PSWR(1 downto 0));
+											elsif (dec_flags = FL_CY) then
+												RAM_POST_BYTE(xD0, alu_cy & PSWR(6 downto 0));
+											end if;
+
+											cpu_state <= T0;
+											exe_state <= E0;
+										when others	=>
+									end case;
+							end case;
+					end case;	--mov/alu/unary
+
+				-- opcodes the core does not implement: no effect, but reported
+				when others =>
+					illegal_op <= '1';
+					exe_state <= E0;
 					cpu_state <= T0;
-			end case; -- IR
+			end case; -- dec_class
     when I0 => -- interrupt
 	end case; --cpu_state
+	end if;
 end if;
 end process;
 end seq_arch;
@@ -54,7 +54,14 @@ ARCHITECTURE behavior OF test_bench IS
          p2_out : OUT  std_logic_vector(7 downto 0);
          p3_in : IN  std_logic_vector(7 downto 0);
          p3_out : OUT  std_logic_vector(7 downto 0);
-         pc_debug : OUT  std_logic_vector(15 downto 0)
+         pc_debug : OUT  std_logic_vector(15 downto 0);
+         trace_mode : IN  std_logic;
+         trace_rd : IN  std_logic;
+         trace_data : OUT  std_logic_vector(33 downto 0);
+         trace_valid : OUT  std_logic;
+         trace_ovf : OUT  std_logic;
+         trace_state : OUT  std_logic_vector(23 downto 0);
+         trace_wr : OUT  std_logic_vector(27 downto 0)
         );
     END COMPONENT;
     
@@ -67,6 +74,8 @@ ARCHITECTURE behavior OF test_bench IS
    signal p1_in : std_logic_vector(7 downto 0) := (others => '0');
    signal p2_in : std_logic_vector(7 downto 0) := (others => '0');
    signal p3_in : std_logic_vector(7 downto 0) := (others => '0');
+   signal trace_mode : std_logic := '0';
+   signal trace_rd : std_logic := '0';
 
  	--Outputs
    signal ale : std_logic;
@@ -76,6 +85,11 @@ ARCHITECTURE behavior OF test_bench IS
    signal p2_out : std_logic_vector(7 downto 0);
    signal p3_out : std_logic_vector(7 downto 0);
    signal pc_debug : std_logic_vector(15 downto 0);
+   signal trace_data : std_logic_vector(33 downto 0);
+   signal trace_valid : std_logic;
+   signal trace_ovf : std_logic;
+   signal trace_state : std_logic_vector(23 downto 0);
+   signal trace_wr : std_logic_vector(27 downto 0);
 
    -- Clock period definitions
    constant clk_period : time := 10 ns;
@@ -97,7 +111,14 @@ BEGIN
           p2_out => p2_out,
           p3_in => p3_in,
           p3_out => p3_out,
-          pc_debug => pc_debug
+          pc_debug => pc_debug,
+          trace_mode => trace_mode,
+          trace_rd => trace_rd,
+          trace_data => trace_data,
+          trace_valid => trace_valid,
+          trace_ovf => trace_ovf,
+          trace_state => trace_state,
+          trace_wr => trace_wr
         );
 
    -- Clock process definitions
@@ -0,0 +1,345 @@
+--------------------------------------------------------------------------------
+-- Module Name:   test_bench_alu.vhd
+-- Project Name:  MyProject
+--
+-- Self-checking test bench for fastalu. Every byte mode operation the
+-- sequencer uses is run for all operand, carry and auxiliary carry
+-- combinations and compared with a behavioural model written here with
+-- integers, independent of csadder:
+--
+--   ADD, ADC, SUB, SBB	result, CY, AC, OV	256 x 256 x 2
+--   AND, OR, XOR		result, CY unchanged	256 x 256 x 2
+--   INC, DEC, NOT, NEG	result			256 x 2
+--   RL, RR, RLC, RRC, SWAP	result, CY for RLC/RRC	256 x 2
+--   DA			result, CY			256 x 2 x 2
+--
+-- Mismatches are reported one by one (at most 20 per operation) and the run
+-- ends with a failure if there were any.
+--------------------------------------------------------------------------------
+LIBRARY ieee;
+USE ieee.std_logic_1164.ALL;
+USE ieee.std_logic_arith.ALL;
+USE ieee.std_logic_unsigned.ALL;
+USE work.constants.ALL;
+
+ENTITY test_bench_alu IS
+END test_bench_alu;
+
+ARCHITECTURE behavior OF test_bench_alu IS
+
+    -- Component Declaration for the Unit Under Test (UUT)
+
+    COMPONENT fastalu
+    PORT(
+         op_code : IN  std_logic_vector(4 downto 0);
+         src_1L : IN  std_logic_vector(7 downto 0);
+         src_1H : IN  std_logic_vector(7 downto 0);
+         src_2L : IN  std_logic_vector(7 downto 0);
+         src_2H : IN  std_logic_vector(7 downto 0);
+         by_wd : IN  std_logic;
+         cy_bw : IN  std_logic;
+         ac_in : IN  std_logic;
+         ans_L : OUT  std_logic_vector(7 downto 0);
+         ans_H : OUT  std_logic_vector(7 downto 0);
+         alu_cy : OUT  std_logic;
+         alu_ac : OUT  std_logic;
+         alu_ov : OUT  std_logic
+        );
+    END COMPONENT;
+
+
+   --Inputs
+   signal op_code : std_logic_vector(4 downto 0) := ALU_OPC_NONE;
+   signal src_1L : std_logic_vector(7 downto 0) := (others => '0');
+   signal src_1H : std_logic_vector(7 downto 0) := (others => '0');
+   signal src_2L : std_logic_vector(7 downto 0) := (others => '0');
+   signal src_2H : std_logic_vector(7 downto 0) := (others => '0');
+   signal by_wd : std_logic := '0';
+   signal cy_bw : std_logic := '0';
+   signal ac_in : std_logic := '0';
+
+ 	--Outputs
+   signal ans_L : std_logic_vector(7 downto 0);
+   signal ans_H : std_logic_vector(7 downto 0);
+   signal alu_cy : std_logic;
+   signal alu_ac : std_logic;
+   signal alu_ov : std_logic;
+
+   -- settling time of the combinational ALU
+   constant settle : time := 1 ns;
+
+   function to_sl (b : boolean) return std_logic is
+   begin
+      if b then
+         return '1';
+      else
+         return '0';
+      end if;
+   end to_sl;
+
+BEGIN
+
+	-- Instantiate the Unit Under Test (UUT)
+   uut: fastalu PORT MAP (
+          op_code => op_code,
+          src_1L => src_1L,
+          src_1H => src_1H,
+          src_2L => src_2L,
+          src_2H => src_2H,
+          by_wd => by_wd,
+          cy_bw => cy_bw,
+          ac_in => ac_in,
+          ans_L => ans_L,
+          ans_H => ans_H,
+          alu_cy => alu_cy,
+          alu_ac => alu_ac,
+          alu_ov => alu_ov
+        );
+
+   -- Stimulus and check process
+   stim_proc: process
+      variable errors	: integer := 0;
+      variable op_err	: integer;
+      variable c, h	: integer;
+      variable r, sr	: integer;
+      variable e_ans	: integer;
+      variable e_cy, e_ac, e_ov	: std_logic;
+      variable chk_fl	: boolean;	-- AC and OV are checked too
+      variable chk_cy	: boolean;
+
+      procedure check (name : string; a, b, ci, ai : integer) is
+      begin
+         if (conv_integer(ans_L) /= e_ans or ans_H /= "00000000"
+               or (chk_cy and alu_cy /= e_cy)
+               or (chk_fl and (alu_ac /= e_ac or alu_ov /= e_ov))) then
+            if (op_err < 20) then
+               report name & " a=" & integer'image(a) & " b=" & integer'image(b)
+                  & " cy=" & integer'image(ci) & " ac=" & integer'image(ai)
+                  & ": got " & integer'image(conv_integer(ans_L))
+                  & " expected " & integer'image(e_ans)
+                  severity error;
+            end if;
+            op_err := op_err + 1;
+         end if;
+      end check;
+
+      procedure done (name : string) is
+      begin
+         report name & ": " & integer'image(op_err) & " mismatches" severity note;
+         errors := errors + op_err;
+      end done;
+   begin
+      wait for settle;
+      by_wd <= BYTE;
+
+      -- ADD/ADC/SUB/SBB: 8051 ADD, ADDC and SUBB (SUB is SUBB with CY clear)
+      for k in 0 to 3 loop
+         case k is
+            when 0 =>	op_code <= ALU_OPC_ADD;
+            when 1 =>	op_code <= ALU_OPC_ADC;
+            when 2 =>	op_code <= ALU_OPC_SUB;
+            when others =>	op_code <= ALU_OPC_SBB;
+         end case;
+         op_err := 0;
+         chk_cy := true;
+         chk_fl := true;
+         for a in 0 to 255 loop
+            for b in 0 to 255 loop
+               for ci in 0 to 1 loop
+                  src_1L <= conv_std_logic_vector(a, 8);
+                  src_2L <= conv_std_logic_vector(b, 8);
+                  cy_bw <= to_sl(ci = 1);
+                  wait for settle;
+
+                  c := 0;
+                  if (k = 1 or k = 3) then
+                     c := ci;
+                  end if;
+                  if (k < 2) then
+                     r := a + b + c;
+                     h := (a mod 16) + (b mod 16) + c;
+                     e_cy := to_sl(r > 255);
+                     e_ac := to_sl(h > 15);
+                  else
+                     r := a - b - c;
+                     h := (a mod 16) - (b mod 16) - c;
+                     e_cy := to_sl(r < 0);
+                     e_ac := to_sl(h < 0);
+                  end if;
+                  -- the same operation on the operands read as signed
+                  sr := a - 256 * (a / 128);
+                  if (k < 2) then
+                     sr := sr + (b - 256 * (b / 128)) + c;
+                  else
+                     sr := sr - (b - 256 * (b / 128)) - c;
+                  end if;
+                  e_ov := to_sl(sr > 127 or sr < -128);
+                  e_ans := (r + 256) mod 256;
+
+                  case k is
+                     when 0 =>	check("ADD", a, b, ci, 0);
+                     when 1 =>	check("ADC", a, b, ci, 0);
+                     when 2 =>	check("SUB", a, b, ci, 0);
+                     when others =>	check("SBB", a, b, ci, 0);
+                  end case;
+               end loop;
+            end loop;
+         end loop;
+         case k is
+            when 0 =>	done("ADD");
+            when 1 =>	done("ADC");
+            when 2 =>	done("SUB");
+            when others =>	done("SBB");
+         end case;
+      end loop;
+
+      -- AND/OR/XOR: the ANL, ORL and XRL family, CY must come back unchanged
+      chk_cy := true;
+      chk_fl := false;
+      for k in 0 to 2 loop
+         case k is
+            when 0 =>	op_code <= ALU_OPC_AND;
+            when 1 =>	op_code <= ALU_OPC_OR;
+            when others =>	op_code <= ALU_OPC_XOR;
+         end case;
+         op_err := 0;
+         for a in 0 to 255 loop
+            for b in 0 to 255 loop
+               for ci in 0 to 1 loop
+                  src_1L <= conv_std_logic_vector(a, 8);
+                  src_2L <= conv_std_logic_vector(b, 8);
+                  cy_bw <= to_sl(ci = 1);
+                  wait for settle;
+
+                  case k is
+                     when 0 =>	e_ans := conv_integer(conv_std_logic_vector(a, 8) and conv_std_logic_vector(b, 8));
+                     when 1 =>	e_ans := conv_integer(conv_std_logic_vector(a, 8) or conv_std_logic_vector(b, 8));
+                     when others =>	e_ans := conv_integer(conv_std_logic_vector(a, 8) xor conv_std_logic_vector(b, 8));
+                  end case;
+                  e_cy := to_sl(ci = 1);
+
+                  case k is
+                     when 0 =>	check("AND", a, b, ci, 0);
+                     when 1 =>	check("OR", a, b, ci, 0);
+                     when others =>	check("XOR", a, b, ci, 0);
+                  end case;
+               end loop;
+            end loop;
+         end loop;
+         case k is
+            when 0 =>	done("AND");
+            when 1 =>	done("OR");
+            when others =>	done("XOR");
+         end case;
+      end loop;
+
+      -- single operand operations on src_1L
+      src_2L <= (others => '0');
+      chk_fl := false;
+      for k in 0 to 8 loop
+         case k is
+            when 0 =>	op_code <= ALU_OPC_INC;
+            when 1 =>	op_code <= ALU_OPC_DEC;
+            when 2 =>	op_code <= ALU_OPC_NOT;
+            when 3 =>	op_code <= ALU_OPC_NEG;
+            when 4 =>	op_code <= ALU_OPC_RL;
+            when 5 =>	op_code <= ALU_OPC_RR;
+            when 6 =>	op_code <= ALU_OPC_RLC;
+            when 7 =>	op_code <= ALU_OPC_RRC;
+            when others =>	op_code <= ALU_OPC_SWAP;
+         end case;
+         op_err := 0;
+         chk_cy := (k = 6 or k = 7);
+         for a in 0 to 255 loop
+            for ci in 0 to 1 loop
+               src_1L <= conv_std_logic_vector(a, 8);
+               cy_bw <= to_sl(ci = 1);
+               wait for settle;
+
+               e_cy := '0';
+               case k is
+                  when 0 =>	e_ans := (a + 1) mod 256;
+                  when 1 =>	e_ans := (a + 255) mod 256;
+                  when 2 =>	e_ans := 255 - a;
+                  when 3 =>	e_ans := (256 - a) mod 256;
+                  when 4 =>	e_ans := (a * 2) mod 256 + a / 128;
+                  when 5 =>	e_ans := a / 2 + 128 * (a mod 2);
+                  when 6 =>
+                     e_ans := (a * 2) mod 256 + ci;
+                     e_cy := to_sl(a >= 128);
+                  when 7 =>
+                     e_ans := a / 2 + 128 * ci;
+                     e_cy := to_sl(a mod 2 = 1);
+                  when others =>	e_ans := (a mod 16) * 16 + a / 16;
+               end case;
+
+               case k is
+                  when 0 =>	check("INC", a, 0, ci, 0);
+                  when 1 =>	check("DEC", a, 0, ci, 0);
+                  when 2 =>	check("NOT", a, 0, ci, 0);
+                  when 3 =>	check("NEG", a, 0, ci, 0);
+                  when 4 =>	check("RL", a, 0, ci, 0);
+                  when 5 =>	check("RR", a, 0, ci, 0);
+                  when 6 =>	check("RLC", a, 0, ci, 0);
+                  when 7 =>	check("RRC", a, 0, ci, 0);
+                  when others =>	check("SWAP", a, 0, ci, 0);
+               end case;
+            end loop;
+         end loop;
+         case k is
+            when 0 =>	done("INC");
+            when 1 =>	done("DEC");
+            when 2 =>	done("NOT");
+            when 3 =>	done("NEG");
+            when 4 =>	done("RL");
+            when 5 =>	done("RR");
+            when 6 =>	done("RLC");
+            when 7 =>	done("RRC");
+            when others =>	done("SWAP");
+         end case;
+      end loop;
+
+      -- DA A: +06h if the low digit is over 9 or AC, then +60h if the high
+      -- digit is over 9 or CY. CY is set by either carry, never cleared.
+      op_code <= ALU_OPC_DA;
+      op_err := 0;
+      chk_cy := true;
+      for a in 0 to 255 loop
+         for ci in 0 to 1 loop
+            for ai in 0 to 1 loop
+               src_1L <= conv_std_logic_vector(a, 8);
+               cy_bw <= to_sl(ci = 1);
+               ac_in <= to_sl(ai = 1);
+               wait for settle;
+
+               r := a;
+               c := ci;
+               if ((r mod 16) > 9 or ai = 1) then
+                  r := r + 6;
+               end if;
+               if (r > 255) then
+                  c := 1;
+               end if;
+               r := r mod 256;
+               if ((r / 16) > 9 or c = 1) then
+                  r := r + 96;
+               end if;
+               if (r > 255) then
+                  c := 1;
+               end if;
+               e_ans := r mod 256;
+               e_cy := to_sl(c = 1);
+               check("DA", a, 0, ci, ai);
+            end loop;
+         end loop;
+      end loop;
+      done("DA");
+
+      assert errors = 0
+         report "fastalu: " & integer'image(errors) & " mismatches"
+         severity failure;
+      report "fastalu: all operations match" severity note;
+      wait;
+   end process;
+
+END;
@@ -0,0 +1,267 @@
+--------------------------------------------------------------------------------
+-- Module Name:   test_bench_fuzz.vhd
+-- Project Name:  MyProject
+--
+-- Port input fuzzing of the port poller firmware (int_rom image 2), with
+-- edge coverage from the trace port.
+--
+-- One run is one input: INPUT_LEN tuples of P0..P3 pin values, each held
+-- for HOLD clk periods. Every run starts from reset, which brings the core
+-- back to the same boot state (internal_ram is cleared by its reset engine,
+-- SFRs and the sequencer are reset), so the reset is the snapshot restore.
+-- The first tuple is applied once the RAM clear is over and the core runs.
+-- Each byte is one of 00h, FFh, 55h, AAh, 80h or a random value, all taken
+-- from a 32 bit LFSR seeded from SEED and the run number, so an input is
+-- reproduced from those two numbers.
+--
+-- The firmware reads the ports with MOV A,direct and branches on the
+-- values. The trace port runs in branch-only mode. Every record is drained
+-- through trace_rd and counted on its own: the edge is the previous record
+-- and this one (target and instructions since the last branch, so paths
+-- through untaken branches differ too), hashed into a 4096 entry map.
+-- After every run the bench reports how many new edges the run found and
+-- the total so far.
+--------------------------------------------------------------------------------
+LIBRARY ieee;
+USE ieee.std_logic_1164.ALL;
+USE ieee.std_logic_arith.ALL;
+USE ieee.std_logic_unsigned.ALL;
+
+ENTITY test_bench_fuzz IS
+   generic (
+      SEED      : integer := 1;         -- first LFSR seed, >= 0
+      RUNS      : integer := 16;
+      INPUT_LEN : integer := 64;        -- port tuples per input
+      HOLD      : integer := 1024       -- clk periods each tuple is held
+   );
+END test_bench_fuzz;
+
+ARCHITECTURE behavior OF test_bench_fuzz IS
+
+    -- Component Declaration for the Unit Under Test (UUT)
+
+    COMPONENT i8051_top
+    GENERIC(
+         ROM_IMAGE : integer := 0;
+         BRANCH_PREDICT : boolean := true
+        );
+    PORT(
+         clk : IN  std_logic;
+         rst : IN  std_logic;
+         ale : OUT  std_logic;
+         psen : OUT  std_logic;
+         ea : IN  std_logic;
+         p0_in : IN  std_logic_vector(7 downto 0);
+         p0_out : OUT  std_logic_vector(7 downto 0);
+         p1_in : IN  std_logic_vector(7 downto 0);
+         p1_out : OUT  std_logic_vector(7 downto 0);
+         p2_in : IN  std_logic_vector(7 downto 0);
+         p2_out : OUT  std_logic_vector(7 downto 0);
+         p3_in : IN  std_logic_vector(7 downto 0);
+         p3_out : OUT  std_logic_vector(7 downto 0);
+         pc_debug : OUT  std_logic_vector(15 downto 0);
+         trace_mode : IN  std_logic;
+         trace_rd : IN  std_logic;
+         trace_data : OUT  std_logic_vector(33 downto 0);
+         trace_valid : OUT  std_logic;
+         trace_ovf : OUT  std_logic;
+         trace_state : OUT  std_logic_vector(23 downto 0);
+         trace_wr : OUT  std_logic_vector(27 downto 0)
+        );
+    END COMPONENT;
+
+
+   --Inputs
+   signal clk : std_logic := '0';
+   signal rst : std_logic := '0';
+   signal ea : std_logic := '0';
+   signal p0_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal p1_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal p2_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal p3_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal trace_mode : std_logic := '1';	-- branch records only
+   signal trace_rd : std_logic := '0';
+
+ 	--Outputs
+   signal ale : std_logic;
+   signal psen : std_logic;
+   signal p0_out : std_logic_vector(7 downto 0);
+   signal p1_out : std_logic_vector(7 downto 0);
+   signal p2_out : std_logic_vector(7 downto 0);
+   signal p3_out : std_logic_vector(7 downto 0);
+   signal pc_debug : std_logic_vector(15 downto 0);
+   signal trace_data : std_logic_vector(33 downto 0);
+   signal trace_valid : std_logic;
+   signal trace_ovf : std_logic;
+   signal trace_state : std_logic_vector(23 downto 0);
+   signal trace_wr : std_logic_vector(27 downto 0);
+
+   -- run handshake between stimulus and coverage
+   signal run_end : integer := -1;	-- input of this run fully applied
+   signal cov_ack : integer := -1;	-- coverage of this run counted
+
+   -- Clock period definitions
+   constant clk_period : time := 10 ns;
+   constant core_div : integer := 16;	-- clk periods per core clock
+   constant clear_clk : integer := 128 * core_div;	-- internal_ram clear after reset
+
+   -- Galois LFSR, x^32 + x^22 + x^2 + x + 1
+   function lfsr_next (s : std_logic_vector(31 downto 0)) return std_logic_vector is
+   begin
+      if (s(0) = '1') then
+         return ('0' & s(31 downto 1)) xor x"80200003";
+      else
+         return '0' & s(31 downto 1);
+      end if;
+   end lfsr_next;
+
+BEGIN
+
+	-- Instantiate the Unit Under Test (UUT)
+   uut: i8051_top GENERIC MAP (
+          ROM_IMAGE => 2
+        ) PORT MAP (
+          clk => clk,
+          rst => rst,
+          ale => ale,
+          psen => psen,
+          ea => ea,
+          p0_in => p0_in,
+          p0_out => p0_out,
+          p1_in => p1_in,
+          p1_out => p1_out,
+          p2_in => p2_in,
+          p2_out => p2_out,
+          p3_in => p3_in,
+          p3_out => p3_out,
+          pc_debug => pc_debug,
+          trace_mode => trace_mode,
+          trace_rd => trace_rd,
+          trace_data => trace_data,
+          trace_valid => trace_valid,
+          trace_ovf => trace_ovf,
+          trace_state => trace_state,
+          trace_wr => trace_wr
+        );
+
+   -- Clock process definitions
+   clk_process :process
+   begin
+		clk <= '0';
+		wait for clk_period/2;
+		clk <= '1';
+		wait for clk_period/2;
+   end process;
+
+
+   -- Stimulus process: reset, then one input per run
+   stim_proc: process
+      variable s	: std_logic_vector(31 downto 0);
+
+      -- next input byte, a dictionary value for three draws in eight
+      procedure next_byte (b : out std_logic_vector(7 downto 0)) is
+      begin
+         for i in 1 to 11 loop
+            s := lfsr_next(s);
+         end loop;
+         case s(10 downto 8) is
+            when "000" =>	b := x"00";
+            when "001" =>	b := x"FF";
+            when "010" =>	b := x"55";
+            when "011" =>	b := x"AA";
+            when "100" =>	b := x"80";
+            when others =>	b := s(7 downto 0);
+         end case;
+      end next_byte;
+
+      variable b	: std_logic_vector(7 downto 0);
+   begin
+      for run in 0 to RUNS-1 loop
+         rst <= '0';
+         p0_in <= (others => '1');
+         p1_in <= (others => '1');
+         p2_in <= (others => '1');
+         p3_in <= (others => '1');
+         s := conv_std_logic_vector(SEED + 1 + run * 7919, 32);
+         wait for clk_period*20;
+         rst <= '1';
+         wait for clk_period*clear_clk;
+
+         for t in 1 to INPUT_LEN loop
+            next_byte(b);
+            p0_in <= b;
+            next_byte(b);
+            p1_in <= b;
+            next_byte(b);
+            p2_in <= b;
+            next_byte(b);
+            p3_in <= b;
+            wait for clk_period*HOLD;
+         end loop;
+
+         run_end <= run;
+         wait until cov_ack = run;
+      end loop;
+      wait;
+   end process;
+
+
+   -- Coverage process: drains every record, rd is seen by exactly one core
+   -- clock edge, and updates the map once per record. When the input of a
+   -- run is over the FIFO is drained until it is empty, so the records still
+   -- queued are charged to this run and not lost in the next reset.
+   cov_proc: process
+      type map_type is array (0 to 4095) of boolean;
+      variable edges	: map_type := (others => false);
+      variable rec	: std_logic_vector(33 downto 0);
+      variable cur	: std_logic_vector(11 downto 0);
+      variable prev	: std_logic_vector(11 downto 0);
+      variable idx	: std_logic_vector(11 downto 0);
+      variable found	: integer;
+      variable total	: integer := 0;
+      variable recs	: integer;
+   begin
+      for run in 0 to RUNS-1 loop
+         wait until rst = '1';
+         prev := (others => '0');
+         found := 0;
+         recs := 0;
+         loop
+            wait until clk'event and clk = '1';
+            exit when run_end = run and trace_valid = '0';
+            if (trace_valid = '1') then
+               rec := trace_data;
+               trace_rd <= '1';
+               for i in 1 to core_div loop
+                  wait until clk'event and clk = '1';
+               end loop;
+               trace_rd <= '0';
+
+               recs := recs + 1;
+               if (rec(32) = '1') then	-- not a sync record
+                  cur := rec(11 downto 0) xor (rec(27 downto 24) & x"00");
+                  idx := ('0' & prev(11 downto 1)) xor cur;
+                  if (not edges(conv_integer(idx))) then
+                     edges(conv_integer(idx)) := true;
+                     found := found + 1;
+                     total := total + 1;
+                  end if;
+                  prev := cur;
+               end if;
+            end if;
+         end loop;
+
+         report "fuzz: run " & integer'image(run) & ", " & integer'image(recs)
+            & " records, " & integer'image(found) & " new edges, "
+            & integer'image(total) & " total" severity note;
+         assert trace_ovf = '0'
+            report "fuzz: trace records dropped" severity warning;
+         cov_ack <= run;
+      end loop;
+
+      report "fuzz: " & integer'image(RUNS) & " runs, "
+         & integer'image(total) & " edges" severity note;
+      wait;
+   end process;
+
+END;
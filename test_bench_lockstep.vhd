@@ -0,0 +1,549 @@
+--------------------------------------------------------------------------------
+-- Module Name:   test_bench_lockstep.vhd
+-- Project Name:  MyProject
+--
+-- Lockstep control flow check of i8051_top against the program image.
+--
+-- The trace port reports every retired instruction (PC, IR, branch taken).
+-- For each record the bench reads the opcode and its operands from its own
+-- copy of int_rom and works out, the way the instruction set defines it,
+-- where the next instruction has to be:
+--
+--   not taken				PC + instruction length
+--   SJMP, Jcc, DJNZ Rn (rel in byte 2)	PC + 2 + rel
+--   JBC/JB/JNB, CJNE, DJNZ dir (byte 3)	PC + 3 + rel
+--   AJMP/ACALL				page of PC + 2, address from IR and byte 2
+--   LJMP/LCALL				byte 2 : byte 3
+--   RET/RETI				return address from a shadow call stack
+--   JMP @A+DPTR			not checked, the bench follows the core
+--
+-- The next record must have that PC and an IR equal to the ROM byte there.
+-- The first difference stops the simulation with a failure, so a wrong
+-- return address pushed by a call or a late stack read in RET shows up at
+-- the instruction that went wrong. Opcodes the core does not implement are
+-- skipped with their opcode byte only, so they are reported here as well.
+--
+-- trace_state gives ACC, PSW and SP after each instruction. The bench keeps
+-- its own ACC, PSW, SP and R0-R7 (bank 0) and steps them for MOV A/Rn/SP/
+-- PSW with immediates, MOV A,Rn, MOV Rn,A, CLR/CPL/INC/DEC A, ADD/ADDC/SUBB
+-- A,#data, CLR/SETB C, CJNE (CY), DJNZ, calls (SP + 2) and returns (SP - 2).
+-- Those registers are compared after the instruction, PSW without the
+-- parity bit. After any other instruction a register the bench can not work
+-- out is taken from the core and the check goes on from there.
+--
+-- trace_wr gives the byte writes to internal RAM and the SFRs made by each
+-- instruction: how many, and address, data and the ind/pair strobes of the
+-- last one. The bench checks them for the opcodes it steps:
+--
+--   MOV Rn,#data / MOV Rn,A / DJNZ Rn	one write to Rn of the current bank
+--   MOV direct,#data / DJNZ direct	one write to direct
+--   ACALL/LCALL				one stack pair at SP + 1, the return address
+--   NOP, jumps, JZ/JNZ, RET/RETI		no write
+--   the ACC/PSW instructions above	at most two, the last to ACC or PSW
+--
+-- Data is compared where the model knows it (DJNZ only for R0-R7 of bank
+-- 0), ind for addresses from 80h up and for the stack. Bit writes and the
+-- writes of any other opcode are not compared.
+--
+-- ROM_IMAGE 3, the default, runs calls, returns and all the branch forms
+-- above, so the bench checks something with the program in the tree.
+--------------------------------------------------------------------------------
+LIBRARY ieee;
+USE ieee.std_logic_1164.ALL;
+USE ieee.std_logic_arith.ALL;
+USE ieee.std_logic_unsigned.ALL;
+
+ENTITY test_bench_lockstep IS
+   generic (
+      ROM_IMAGE : integer := 3;         -- int_rom program, see int_rom.vhd
+      MAX_INSTR : integer := 100000     -- instructions checked before the bench stops
+   );
+END test_bench_lockstep;
+
+ARCHITECTURE behavior OF test_bench_lockstep IS
+
+    -- Component Declaration for the Unit Under Test (UUT)
+
+    COMPONENT i8051_top
+    GENERIC(
+         ROM_IMAGE : integer := 0;
+         BRANCH_PREDICT : boolean := true
+        );
+    PORT(
+         clk : IN  std_logic;
+         rst : IN  std_logic;
+         ale : OUT  std_logic;
+         psen : OUT  std_logic;
+         ea : IN  std_logic;
+         p0_in : IN  std_logic_vector(7 downto 0);
+         p0_out : OUT  std_logic_vector(7 downto 0);
+         p1_in : IN  std_logic_vector(7 downto 0);
+         p1_out : OUT  std_logic_vector(7 downto 0);
+         p2_in : IN  std_logic_vector(7 downto 0);
+         p2_out : OUT  std_logic_vector(7 downto 0);
+         p3_in : IN  std_logic_vector(7 downto 0);
+         p3_out : OUT  std_logic_vector(7 downto 0);
+         pc_debug : OUT  std_logic_vector(15 downto 0);
+         trace_mode : IN  std_logic;
+         trace_rd : IN  std_logic;
+         trace_data : OUT  std_logic_vector(33 downto 0);
+         trace_valid : OUT  std_logic;
+         trace_ovf : OUT  std_logic;
+         trace_state : OUT  std_logic_vector(23 downto 0);
+         trace_wr : OUT  std_logic_vector(27 downto 0)
+        );
+    END COMPONENT;
+
+    -- reference copy of the program image
+    COMPONENT int_rom
+    GENERIC(
+         ADDR_WIDTH : integer := 12;
+         IMAGE : integer := 0
+        );
+    PORT(
+         clk : IN  std_logic;
+         rst : IN  std_logic;
+         rd : IN  std_logic;
+         addr : IN  std_logic_vector(15 downto 0);
+         data : OUT  std_logic_vector(7 downto 0)
+        );
+    END COMPONENT;
+
+
+   --Inputs
+   signal clk : std_logic := '0';
+   signal rst : std_logic := '0';
+   signal ea : std_logic := '0';
+   signal p0_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal p1_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal p2_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal p3_in : std_logic_vector(7 downto 0) := (others => '1');
+   signal trace_mode : std_logic := '0';	-- one record per instruction
+   signal trace_rd : std_logic := '0';
+   signal rom_addr : std_logic_vector(15 downto 0) := (others => '0');
+
+ 	--Outputs
+   signal ale : std_logic;
+   signal psen : std_logic;
+   signal p0_out : std_logic_vector(7 downto 0);
+   signal p1_out : std_logic_vector(7 downto 0);
+   signal p2_out : std_logic_vector(7 downto 0);
+   signal p3_out : std_logic_vector(7 downto 0);
+   signal pc_debug : std_logic_vector(15 downto 0);
+   signal trace_data : std_logic_vector(33 downto 0);
+   signal trace_valid : std_logic;
+   signal trace_ovf : std_logic;
+   signal trace_state : std_logic_vector(23 downto 0);
+   signal trace_wr : std_logic_vector(27 downto 0);
+   signal rom_data : std_logic_vector(7 downto 0);
+
+   -- Clock period definitions
+   constant clk_period : time := 10 ns;
+   -- the core runs on clk/16, a trace record is drained in one core clock
+   constant core_div : integer := 16;
+
+   -- instruction length in bytes by opcode, A5 (16 bit prefix) is sized
+   -- from its second byte
+   type len_type is array (0 to 255) of integer range 1 to 3;
+   constant LEN : len_type := (
+      1, 2, 3, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 00
+      3, 2, 3, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 10
+      3, 2, 1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 20
+      3, 2, 1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 30
+      2, 2, 2, 3, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 40
+      2, 2, 2, 3, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 50
+      2, 2, 2, 3, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 60
+      2, 2, 2, 1, 2, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,	-- 70
+      2, 2, 2, 1, 1, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,	-- 80
+      3, 2, 2, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- 90
+      2, 2, 2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,	-- A0
+      2, 2, 2, 1, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,	-- B0
+      2, 2, 2, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- C0
+      2, 2, 2, 1, 1, 3, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2,	-- D0
+      1, 2, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	-- E0
+      1, 2, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1	-- F0
+   );
+
+   -- what the checker expects the instruction to write
+   constant W_NONE : integer := 0;	-- no byte write
+   constant W_ONE : integer := 1;	-- exactly one, address and data known
+   constant W_ACC : integer := 2;	-- ACC/PSW only, at most two
+   constant W_ANY : integer := 3;	-- not checked
+
+   function to_sl (b : boolean) return std_logic is
+   begin
+      if b then
+         return '1';
+      else
+         return '0';
+      end if;
+   end to_sl;
+
+   -- relative offset in an operand byte
+   function rel (b : integer) return integer is
+   begin
+      if (b >= 128) then
+         return b - 256;
+      else
+         return b;
+      end if;
+   end rel;
+
+BEGIN
+
+	-- Instantiate the Unit Under Test (UUT)
+   uut: i8051_top GENERIC MAP (
+          ROM_IMAGE => ROM_IMAGE
+        ) PORT MAP (
+          clk => clk,
+          rst => rst,
+          ale => ale,
+          psen => psen,
+          ea => ea,
+          p0_in => p0_in,
+          p0_out => p0_out,
+          p1_in => p1_in,
+          p1_out => p1_out,
+          p2_in => p2_in,
+          p2_out => p2_out,
+          p3_in => p3_in,
+          p3_out => p3_out,
+          pc_debug => pc_debug,
+          trace_mode => trace_mode,
+          trace_rd => trace_rd,
+          trace_data => trace_data,
+          trace_valid => trace_valid,
+          trace_ovf => trace_ovf,
+          trace_state => trace_state,
+          trace_wr => trace_wr
+        );
+
+   golden: int_rom GENERIC MAP (
+          IMAGE => ROM_IMAGE
+        ) PORT MAP (
+          clk => clk,
+          rst => '0',
+          rd => '1',
+          addr => rom_addr,
+          data => rom_data
+        );
+
+   -- Clock process definitions
+   clk_process :process
+   begin
+		clk <= '0';
+		wait for clk_period/2;
+		clk <= '1';
+		wait for clk_period/2;
+   end process;
+
+
+   -- Stimulus process
+   stim_proc: process
+   begin
+      -- hold reset state for 100 ns.
+      wait for 100 ns;
+		rst <= '1';
+      wait;
+   end process;
+
+
+   -- Checker: one trace record at a time, in retirement order
+   check_proc: process
+      type stack_type is array (0 to 63) of integer;
+      variable stack	: stack_type;
+      variable depth	: integer := 0;		-- shadow call stack
+      variable expect	: integer := 0;		-- next PC, -1 when not known
+      variable pc, ir	: integer;
+      variable b1, b2	: integer;
+      variable n	: integer;
+      variable nxt	: integer;
+      variable taken	: std_logic;
+
+      -- register model, -1 for a register not known
+      type regs_type is array (0 to 7) of integer;
+      variable r	: regs_type := (others => 0);	-- RAM is cleared in reset
+      variable acc	: integer := 0;
+      variable psw	: std_logic_vector(7 downto 0) := (others => '0');
+      variable sp	: integer := 7;
+      variable chk_acc, chk_psw, chk_sp	: boolean;
+      variable st	: std_logic_vector(23 downto 0);
+      variable v, h, c	: integer;
+
+      -- expected RAM/SFR byte writes of the instruction
+      variable w_kind	: integer;
+      variable w_addr, w_data, w_hi	: integer;	-- w_data -1 when not known
+      variable w_ind, w_pair	: std_logic;
+      variable bank	: integer;
+      variable wrec	: std_logic_vector(27 downto 0);
+      variable wn, wa, wd, wh	: integer;
+
+      procedure expect_write (a, d : integer) is
+      begin
+         w_kind := W_ONE;
+         w_addr := a;
+         w_data := d;
+         w_ind := '0';
+         w_pair := '0';
+      end expect_write;
+
+      -- byte of the program image, read on the falling edge like the core's ROM
+      procedure rom_read (a : integer; d : out integer) is
+      begin
+         rom_addr <= conv_std_logic_vector(a mod 65536, 16);
+         wait until clk'event and clk = '0';
+         wait for 1 ns;
+         d := conv_integer(rom_data);
+      end rom_read;
+   begin
+      wait until rst = '1';
+
+      for count in 1 to MAX_INSTR loop
+         loop
+            wait until clk'event and clk = '1';
+            exit when trace_valid = '1';
+         end loop;
+         pc := conv_integer(trace_data(15 downto 0));
+         ir := conv_integer(trace_data(23 downto 16));
+         taken := trace_data(32);
+         st := trace_state;
+         wrec := trace_wr;
+
+         -- drain the record: rd is seen by exactly one core clock edge
+         trace_rd <= '1';
+         for i in 1 to core_div loop
+            wait until clk'event and clk = '1';
+         end loop;
+         trace_rd <= '0';
+
+         assert expect < 0 or pc = expect
+            report "lockstep: instruction " & integer'image(count)
+               & " at PC " & integer'image(pc)
+               & ", expected PC " & integer'image(expect)
+            severity failure;
+
+         rom_read(pc, n);
+         assert ir = n
+            report "lockstep: IR " & integer'image(ir) & " at PC " & integer'image(pc)
+               & ", ROM has " & integer'image(n)
+            severity failure;
+         rom_read(pc + 1, b1);
+         rom_read(pc + 2, b2);
+
+         n := LEN(ir);
+         if (ir = 16#A5#) then
+            if (b1 = 16#24# or b1 = 16#94#) then
+               n := 4;
+            else
+               n := 2;
+            end if;
+         end if;
+         nxt := (pc + n) mod 65536;
+
+         -- calls push the return address, whether or not the core gets it right
+         if (ir mod 32 = 16#11# or ir = 16#12#) and depth <= 63 then
+            stack(depth) := nxt;
+            depth := depth + 1;
+         end if;
+
+         if (taken = '0') then
+            expect := nxt;
+         elsif (ir mod 32 = 16#01# or ir mod 32 = 16#11#) then	--AJMP, ACALL
+            expect := ((pc + 2) mod 65536) - ((pc + 2) mod 2048) + (ir / 32) * 256 + b1;
+         elsif (ir = 16#02# or ir = 16#12#) then	--LJMP, LCALL
+            expect := b1 * 256 + b2;
+         elsif (ir = 16#40# or ir = 16#50# or ir = 16#60# or ir = 16#70# or ir = 16#80#
+               or (ir >= 16#D8# and ir <= 16#DF#)) then	--SJMP, JC..JNZ, DJNZ Rn
+            expect := (nxt + rel(b1) + 65536) mod 65536;
+         elsif (ir = 16#10# or ir = 16#20# or ir = 16#30# or ir = 16#D5#
+               or (ir >= 16#B4# and ir <= 16#BF#)) then	--JBC, JB, JNB, DJNZ dir, CJNE
+            expect := (nxt + rel(b2) + 65536) mod 65536;
+         elsif (ir = 16#22# or ir = 16#32#) then	--RET, RETI
+            if (depth > 0) then
+               depth := depth - 1;
+               expect := stack(depth);
+            else
+               expect := -1;
+            end if;
+         else
+            expect := -1;	--JMP @A+DPTR
+         end if;
+
+         -- step the register model
+         chk_acc := true;
+         chk_psw := true;
+         chk_sp := true;
+         w_kind := W_ANY;
+         bank := conv_integer(psw(4 downto 3)) * 8;
+         if (psw(4 downto 3) /= "00") then
+            r := (others => -1);	-- only bank 0 is modelled
+         end if;
+         if (ir = 16#74#) then	--MOV A,#data
+            acc := b1;
+            w_kind := W_ACC;
+         elsif (ir = 16#E4#) then	--CLR A
+            acc := 0;
+            w_kind := W_ACC;
+         elsif (ir = 16#F4#) then	--CPL A
+            acc := 255 - acc;
+            w_kind := W_ACC;
+         elsif (ir = 16#04#) then	--INC A
+            acc := (acc + 1) mod 256;
+            w_kind := W_ACC;
+         elsif (ir = 16#14#) then	--DEC A
+            acc := (acc + 255) mod 256;
+            w_kind := W_ACC;
+         elsif (ir = 16#24# or ir = 16#34# or ir = 16#94#) then	--ADD, ADDC, SUBB A,#data
+            c := 0;
+            if (ir /= 16#24# and psw(7) = '1') then
+               c := 1;
+            end if;
+            if (ir = 16#94#) then
+               v := acc - b1 - c;
+               h := (acc mod 16) - (b1 mod 16) - c;
+               psw(7) := to_sl(v < 0);
+               psw(6) := to_sl(h < 0);
+               c := (acc - 256 * (acc / 128)) - (b1 - 256 * (b1 / 128)) - c;
+            else
+               v := acc + b1 + c;
+               h := (acc mod 16) + (b1 mod 16) + c;
+               psw(7) := to_sl(v > 255);
+               psw(6) := to_sl(h > 15);
+               c := (acc - 256 * (acc / 128)) + (b1 - 256 * (b1 / 128)) + c;
+            end if;
+            psw(2) := to_sl(c > 127 or c < -128);
+            acc := (v + 256) mod 256;
+            w_kind := W_ACC;
+         elsif (ir = 16#C3#) then	--CLR C
+            psw(7) := '0';
+            w_kind := W_ACC;
+         elsif (ir = 16#D3#) then	--SETB C
+            psw(7) := '1';
+            w_kind := W_ACC;
+         elsif (ir = 16#B4#) then	--CJNE A,#data
+            psw(7) := to_sl(acc < b1);
+            w_kind := W_ACC;
+         elsif (ir >= 16#B8# and ir <= 16#BF#) then	--CJNE Rn,#data
+            w_kind := W_ACC;
+            if (r(ir - 16#B8#) >= 0) then
+               psw(7) := to_sl(r(ir - 16#B8#) < b1);
+            else
+               chk_psw := false;
+            end if;
+         elsif (ir >= 16#78# and ir <= 16#7F#) then	--MOV Rn,#data
+            r(ir - 16#78#) := b1;
+            expect_write(bank + ir - 16#78#, b1);
+         elsif (ir >= 16#E8# and ir <= 16#EF#) then	--MOV A,Rn
+            acc := r(ir - 16#E8#);
+            chk_acc := acc >= 0;
+            w_kind := W_ACC;
+         elsif (ir >= 16#F8# and ir <= 16#FF#) then	--MOV Rn,A
+            r(ir - 16#F8#) := acc;
+            expect_write(bank + ir - 16#F8#, acc);
+         elsif (ir >= 16#D8# and ir <= 16#DF#) then	--DJNZ Rn
+            if (r(ir - 16#D8#) >= 0) then
+               r(ir - 16#D8#) := (r(ir - 16#D8#) + 255) mod 256;
+            end if;
+            expect_write(bank + ir - 16#D8#, r(ir - 16#D8#));
+         elsif (ir = 16#75#) then	--MOV direct,#data
+            expect_write(b1, b2);
+            if (b1 < 8) then
+               r(b1) := b2;
+            elsif (b1 = 16#E0#) then
+               acc := b2;
+            elsif (b1 = 16#D0#) then
+               psw := conv_std_logic_vector(b2, 8);
+            elsif (b1 = 16#81#) then
+               sp := b2;
+            end if;
+         elsif (ir = 16#D5#) then	--DJNZ direct
+            expect_write(b1, -1);
+            if (b1 < 8) then
+               if (r(b1) >= 0) then
+                  r(b1) := (r(b1) + 255) mod 256;
+               end if;
+               w_data := r(b1);
+            elsif (b1 = 16#E0# or b1 = 16#D0# or b1 = 16#81#) then
+               chk_acc := false;
+               chk_psw := false;
+               chk_sp := false;
+            end if;
+         elsif (ir mod 32 = 16#11# or ir = 16#12#) then	--ACALL, LCALL
+            expect_write((sp + 1) mod 256, nxt mod 256);	-- return address pair
+            w_ind := '1';
+            w_pair := '1';
+            w_hi := nxt / 256;
+            sp := (sp + 2) mod 256;
+         elsif (ir = 16#22# or ir = 16#32#) then	--RET, RETI
+            sp := (sp + 254) mod 256;
+            w_kind := W_NONE;
+         elsif (ir = 16#00# or ir mod 32 = 16#01# or ir = 16#02# or ir = 16#60#
+               or ir = 16#70# or ir = 16#73# or ir = 16#80#) then
+            w_kind := W_NONE;	--NOP, jumps, JZ/JNZ: no register changes
+         else
+            chk_acc := false;
+            chk_psw := false;
+            chk_sp := false;
+            r := (others => -1);
+         end if;
+
+         assert not chk_acc or acc = conv_integer(st(23 downto 16))
+            report "lockstep: ACC " & integer'image(conv_integer(st(23 downto 16)))
+               & " after PC " & integer'image(pc) & ", expected " & integer'image(acc)
+            severity failure;
+         assert not chk_psw or psw(7 downto 1) = st(15 downto 9)
+            report "lockstep: PSW " & integer'image(conv_integer(st(15 downto 8)))
+               & " after PC " & integer'image(pc) & ", expected " & integer'image(conv_integer(psw))
+               & " (parity not compared)"
+            severity failure;
+         assert not chk_sp or sp = conv_integer(st(7 downto 0))
+            report "lockstep: SP " & integer'image(conv_integer(st(7 downto 0)))
+               & " after PC " & integer'image(pc) & ", expected " & integer'image(sp)
+            severity failure;
+
+         -- byte writes: exactly the one expected, none, or for ACC/PSW
+         -- instructions at most two, the last to ACC or PSW
+         wn := conv_integer(wrec(27 downto 26));
+         wa := conv_integer(wrec(23 downto 16));
+         wd := conv_integer(wrec(15 downto 8));
+         wh := conv_integer(wrec(7 downto 0));
+         if (w_kind = W_NONE) then
+            assert wn = 0
+               report "lockstep: " & integer'image(wn) & " RAM/SFR writes at PC "
+                  & integer'image(pc) & ", expected none"
+               severity failure;
+         elsif (w_kind = W_ONE) then
+            assert wn = 1 and wa = w_addr and wrec(25) = w_pair
+                  and (wa < 128 or wrec(24) = w_ind)
+                  and (w_data < 0 or wd = w_data)
+                  and (w_pair = '0' or wh = w_hi)
+               report "lockstep: write at PC " & integer'image(pc) & ": "
+                  & integer'image(wn) & " writes, last " & integer'image(wd)
+                  & " to " & integer'image(wa) & ", expected " & integer'image(w_data)
+                  & " to " & integer'image(w_addr)
+               severity failure;
+         elsif (w_kind = W_ACC and wn > 0) then
+            assert wn <= 2 and wrec(25 downto 24) = "00"
+                  and ((wa = 16#E0# and (not chk_acc or wd = acc))
+                     or (wa = 16#D0# and (not chk_psw or wrec(15 downto 9) = psw(7 downto 1))))
+               report "lockstep: write at PC " & integer'image(pc) & ": "
+                  & integer'image(wn) & " writes, last " & integer'image(wd)
+                  & " to " & integer'image(wa) & ", expected ACC or PSW"
+               severity failure;
+         end if;
+
+         -- go on from the core's values, the same as the model where compared
+         acc := conv_integer(st(23 downto 16));
+         psw := st(15 downto 8);
+         sp := conv_integer(st(7 downto 0));
+
+         assert trace_ovf = '0'
+            report "lockstep: trace records dropped, the check has lost sync"
+            severity failure;
+      end loop;
+
+      report "lockstep: " & integer'image(MAX_INSTR) & " instructions match" severity note;
+      wait;
+   end process;
+
+END;
@@ -0,0 +1,197 @@
+--------------------------------------------------------------------------------
+-- Module Name:   test_bench_loop.vhd
+-- Project Name:  MyProject
+--
+-- Loop benchmark for the static branch prediction in sequencer2.
+--
+-- Two cores run int_rom image 1, one with BRANCH_PREDICT and one without.
+-- The image is a DJNZ R6 loop nested in a DJNZ R7 loop (10 x 100) and a
+-- 100 pass loop closed by DJNZ 30h, so every loop closes with a backward
+-- DJNZ, which PREDICT covers. The bench reports the clk cycles each core
+-- takes from reset release to the SJMP $ at 0010h, and the difference.
+--------------------------------------------------------------------------------
+LIBRARY ieee;
+USE ieee.std_logic_1164.ALL;
+ 
+ENTITY test_bench_loop IS
+END test_bench_loop;
+ 
+ARCHITECTURE behavior OF test_bench_loop IS 
+ 
+    -- Component Declaration for the Unit Under Test (UUT)
+ 
+    COMPONENT i8051_top
+    GENERIC(
+         ROM_IMAGE : integer := 0;
+         BRANCH_PREDICT : boolean := true
+        );
+    PORT(
+         clk : IN  std_logic;
+         rst : IN  std_logic;
+         ale : OUT  std_logic;
+         psen : OUT  std_logic;
+         ea : IN  std_logic;
+         p0_in : IN  std_logic_vector(7 downto 0);
+         p0_out : OUT  std_logic_vector(7 downto 0);
+         p1_in : IN  std_logic_vector(7 downto 0);
+         p1_out : OUT  std_logic_vector(7 downto 0);
+         p2_in : IN  std_logic_vector(7 downto 0);
+         p2_out : OUT  std_logic_vector(7 downto 0);
+         p3_in : IN  std_logic_vector(7 downto 0);
+         p3_out : OUT  std_logic_vector(7 downto 0);
+         pc_debug : OUT  std_logic_vector(15 downto 0);
+         trace_mode : IN  std_logic;
+         trace_rd : IN  std_logic;
+         trace_data : OUT  std_logic_vector(33 downto 0);
+         trace_valid : OUT  std_logic;
+         trace_ovf : OUT  std_logic;
+         trace_state : OUT  std_logic_vector(23 downto 0);
+         trace_wr : OUT  std_logic_vector(27 downto 0)
+        );
+    END COMPONENT;
+    
+
+   --Inputs
+   signal clk : std_logic := '0';
+   signal rst : std_logic := '0';
+   signal ea : std_logic := '0';
+   signal p0_in : std_logic_vector(7 downto 0) := (others => '0');
+   signal p1_in : std_logic_vector(7 downto 0) := (others => '0');
+   signal p2_in : std_logic_vector(7 downto 0) := (others => '0');
+   signal p3_in : std_logic_vector(7 downto 0) := (others => '0');
+   signal trace_mode : std_logic := '0';
+   signal trace_rd : std_logic := '0';
+
+ 	--Outputs
+   signal ale : std_logic;
+   signal psen : std_logic;
+   signal p0_out : std_logic_vector(7 downto 0);
+   signal p1_out : std_logic_vector(7 downto 0);
+   signal p2_out : std_logic_vector(7 downto 0);
+   signal p3_out : std_logic_vector(7 downto 0);
+   signal pc_debug : std_logic_vector(15 downto 0);
+   signal trace_data : std_logic_vector(33 downto 0);
+   signal trace_valid : std_logic;
+   signal trace_ovf : std_logic;
+   signal trace_state : std_logic_vector(23 downto 0);
+   signal trace_wr : std_logic_vector(27 downto 0);
+   signal pc_debug_np : std_logic_vector(15 downto 0);
+
+   -- where the loop benchmark ends, and a bound on how long it may take
+   constant BENCH_END : std_logic_vector(15 downto 0) := x"0010";
+   constant MAX_CYCLES : integer := 1000000;
+
+   -- Clock period definitions
+   constant clk_period : time := 10 ns;
+ 
+BEGIN
+ 
+	-- Instantiate the Unit Under Test (UUT)
+   uut: i8051_top GENERIC MAP (
+          ROM_IMAGE => 1,
+          BRANCH_PREDICT => true
+        ) PORT MAP (
+          clk => clk,
+          rst => rst,
+          ale => ale,
+          psen => psen,
+          ea => ea,
+          p0_in => p0_in,
+          p0_out => p0_out,
+          p1_in => p1_in,
+          p1_out => p1_out,
+          p2_in => p2_in,
+          p2_out => p2_out,
+          p3_in => p3_in,
+          p3_out => p3_out,
+          pc_debug => pc_debug,
+          trace_mode => trace_mode,
+          trace_rd => trace_rd,
+          trace_data => trace_data,
+          trace_valid => trace_valid,
+          trace_ovf => trace_ovf,
+          trace_state => trace_state,
+          trace_wr => trace_wr
+        );
+
+   -- the same core and program without branch prediction
+   uut_np: i8051_top GENERIC MAP (
+          ROM_IMAGE => 1,
+          BRANCH_PREDICT => false
+        ) PORT MAP (
+          clk => clk,
+          rst => rst,
+          ale => open,
+          psen => open,
+          ea => ea,
+          p0_in => p0_in,
+          p0_out => open,
+          p1_in => p1_in,
+          p1_out => open,
+          p2_in => p2_in,
+          p2_out => open,
+          p3_in => p3_in,
+          p3_out => open,
+          pc_debug => pc_debug_np,
+          trace_mode => trace_mode,
+          trace_rd => trace_rd,
+          trace_data => open,
+          trace_valid => open,
+          trace_ovf => open,
+          trace_state => open,
+          trace_wr => open
+        );
+
+   -- Clock process definitions
+   clk_process :process
+   begin
+		clk <= '0';
+		wait for clk_period/2;
+		clk <= '1';
+		wait for clk_period/2;
+   end process;
+ 
+
+   -- Stimulus process
+   stim_proc: process
+   begin		
+      -- hold reset state for 100 ns.
+      wait for 100 ns;	
+     rst <= '1';
+	  
+
+      -- insert stimulus here 
+
+      wait;
+   end process;
+
+   -- Cycle count to the end of the loop benchmark, in clk periods from reset
+   -- release. Both counts include the same internal RAM clear.
+   measure_proc: process
+      variable n : integer := 0;
+      variable n_p : integer := -1;
+      variable n_np : integer := -1;
+   begin
+      wait until rst = '1';
+      while ((n_p < 0 or n_np < 0) and n < MAX_CYCLES) loop
+         wait until clk'event and clk = '1';
+         n := n + 1;
+         if (n_p < 0 and pc_debug = BENCH_END) then
+            n_p := n;
+         end if;
+         if (n_np < 0 and pc_debug_np = BENCH_END) then
+            n_np := n;
+         end if;
+      end loop;
+
+      assert (n_p >= 0 and n_np >= 0)
+         report "loop benchmark did not reach 0010h" severity failure;
+      report "loop benchmark: " & integer'image(n_p) & " clk with prediction, "
+         & integer'image(n_np) & " clk without, "
+         & integer'image(n_np - n_p) & " saved" severity note;
+      assert n_p <= n_np
+         report "loop benchmark: prediction made it slower" severity error;
+      wait;
+   end process;
+
+END;
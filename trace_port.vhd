@@ -0,0 +1,200 @@
+library IEEE;
+use IEEE.std_logic_1164.all;
+use IEEE.std_logic_arith.all;
+use IEEE.std_logic_unsigned.all;
+
+-- Non-intrusive instruction trace. The sequencer reports every retired
+-- instruction; records are queued in a FIFO that external logic or a test
+-- bench drains through rd/data/valid.
+--
+-- mode = '0' : one record per retired instruction
+--	33	'0' (instruction record)
+--	32	branch taken
+--	31-24	E-states since the previous retirement (saturates at 255)
+--	23-16	IR
+--	15-0	PC of the instruction
+--
+-- mode = '1' : branch-only, one record per taken branch
+--	33	'1' (branch record)
+--	32	branch taken ('0' only for a sync record, see below)
+--	31-24	instructions retired since the previous record, this one included
+--	23-16	IR of the branch
+--	15-0	branch target (address of the next instruction)
+--
+-- The straight-line instructions between two branch records are recovered by
+-- walking the program image from the previous target. A sync record is
+-- emitted when the instruction count would overflow.
+--
+-- state carries ACC, PSW and SP after the instruction of the record on data
+-- (23-16 ACC, 15-8 PSW, 7-0 SP; after the branch in mode 1). The retirement
+-- inputs are registered once before a record is queued, so the write a
+-- retiring instruction issues in its last state has landed by then, and the
+-- next instruction has not written yet.
+--
+-- writes gives the RAM/SFR byte writes of the same instruction (of the
+-- branch in mode 1): 27-26 number of writes (saturates at 3), and of the
+-- last one 25 pair, 24 ind, 23-16 address, 15-8 data, 7-0 data at address
+-- + 1 for a pair. A write strobe seen together with retire belongs to the
+-- retiring instruction, posted writes drain before it retires. Bit writes
+-- are not reported.
+--
+-- ovf is sticky and reports that records were dropped on a full FIFO.
+
+entity trace_port is
+generic (DEPTH_LOG2 : integer := 4);
+port (
+	clk		:	in std_logic;
+	rst		:	in std_logic;
+	mode		:	in std_logic;
+
+	retire	:	in std_logic;
+	ret_pc	:	in std_logic_vector(15 downto 0);
+	ret_ir	:	in std_logic_vector(7 downto 0);
+	ret_taken	:	in std_logic;
+	next_pc	:	in std_logic_vector(15 downto 0);
+	ret_acc	:	in std_logic_vector(7 downto 0);
+	ret_psw	:	in std_logic_vector(7 downto 0);
+	ret_sp	:	in std_logic_vector(7 downto 0);
+
+	wr		:	in std_logic;	-- RAM/SFR byte write strobe
+	wr_addr	:	in std_logic_vector(7 downto 0);
+	wr_ind	:	in std_logic;
+	wr_pair	:	in std_logic;
+	wr_data	:	in std_logic_vector(7 downto 0);
+	wr_hi		:	in std_logic_vector(7 downto 0);
+
+	rd		:	in std_logic;
+	data		:	out std_logic_vector(33 downto 0);
+	valid		:	out std_logic;
+	state		:	out std_logic_vector(23 downto 0);
+	writes	:	out std_logic_vector(27 downto 0);
+	ovf		:	out std_logic
+);
+end trace_port;
+
+architecture rtl of trace_port is
+
+	type fifo_type is array (0 to 2**DEPTH_LOG2-1) of std_logic_vector(33 downto 0);
+	signal FIFO		: fifo_type;
+	type state_fifo_type is array (0 to 2**DEPTH_LOG2-1) of std_logic_vector(23 downto 0);
+	signal SFIFO	: state_fifo_type;
+	type write_fifo_type is array (0 to 2**DEPTH_LOG2-1) of std_logic_vector(27 downto 0);
+	signal WFIFO	: write_fifo_type;
+	signal wr_ptr	: std_logic_vector(DEPTH_LOG2-1 downto 0);
+	signal rd_ptr	: std_logic_vector(DEPTH_LOG2-1 downto 0);
+	signal count	: std_logic_vector(DEPTH_LOG2 downto 0);
+
+	signal delta	: std_logic_vector(7 downto 0);	-- E-states since last retirement
+	signal icount	: std_logic_vector(7 downto 0);	-- instructions since last branch record
+
+	signal retire_q	: std_logic;	-- retirement inputs, one clock late
+	signal pc_q		: std_logic_vector(15 downto 0);
+	signal ir_q		: std_logic_vector(7 downto 0);
+	signal taken_q	: std_logic;
+	signal next_q	: std_logic_vector(15 downto 0);
+
+	signal cur_wr	: std_logic_vector(27 downto 0);	-- writes of the instruction in flight
+	signal wr_upd	: std_logic_vector(27 downto 0);	-- the same with this clock's write
+	signal wr_n		: std_logic_vector(1 downto 0);
+	signal ret_wr	: std_logic_vector(27 downto 0);	-- writes of the retired instruction
+
+	signal rec		: std_logic_vector(33 downto 0);
+	signal push		: std_logic;
+	signal accept	: std_logic;
+	signal pop		: std_logic;
+	signal full		: std_logic;
+	signal empty	: std_logic;
+
+begin
+
+	full <= count(DEPTH_LOG2);
+	empty <= '1' when count = 0 else '0';
+	pop <= rd and not empty;
+	accept <= push and (not full or pop);
+
+	wr_n <= cur_wr(27 downto 26) when cur_wr(27 downto 26) = "11" else cur_wr(27 downto 26) + '1';
+	wr_upd <= wr_n & wr_pair & wr_ind & wr_addr & wr_data & wr_hi when wr = '1' else cur_wr;
+
+	process (mode, retire_q, pc_q, ir_q, taken_q, next_q, delta, icount)
+	begin
+		if (mode = '0') then
+			rec <= '0' & taken_q & delta & ir_q & pc_q;
+			push <= retire_q;
+		else
+			rec <= '1' & taken_q & (icount + '1') & ir_q & next_q;
+			if (taken_q = '1' or icount = "11111110") then
+				push <= retire_q;
+			else
+				push <= '0';
+			end if;
+		end if;
+	end process;
+
+	process (clk, rst)
+	begin
+	if (rst = '1') then
+		wr_ptr <= (others => '0');
+		rd_ptr <= (others => '0');
+		count <= (others => '0');
+		delta <= "00000001";
+		icount <= (others => '0');
+		ovf <= '0';
+		retire_q <= '0';
+		cur_wr <= (others => '0');
+		ret_wr <= (others => '0');
+
+	elsif (clk'event and clk = '1') then
+		retire_q <= retire;
+		pc_q <= ret_pc;
+		ir_q <= ret_ir;
+		taken_q <= ret_taken;
+		next_q <= next_pc;
+
+		if (retire = '1') then
+			ret_wr <= wr_upd;
+			cur_wr <= (others => '0');
+		else
+			cur_wr <= wr_upd;
+		end if;
+
+		if (retire_q = '1') then
+			delta <= "00000001";
+		elsif (delta /= "11111111") then
+			delta <= delta + '1';
+		end if;
+
+		if (retire_q = '1') then
+			if (push = '1') then
+				icount <= (others => '0');
+			else
+				icount <= icount + '1';
+			end if;
+		end if;
+
+		if (accept = '1') then
+			FIFO(conv_integer(wr_ptr)) <= rec;
+			SFIFO(conv_integer(wr_ptr)) <= ret_acc & ret_psw & ret_sp;
+			WFIFO(conv_integer(wr_ptr)) <= ret_wr;
+			wr_ptr <= wr_ptr + '1';
+		elsif (push = '1') then
+			ovf <= '1';
+		end if;
+
+		if (pop = '1') then
+			rd_ptr <= rd_ptr + '1';
+		end if;
+
+		if (accept = '1' and pop = '0') then
+			count <= count + '1';
+		elsif (accept = '0' and pop = '1') then
+			count <= count - '1';
+		end if;
+	end if;
+	end process;
+
+	data <= FIFO(conv_integer(rd_ptr));
+	valid <= not empty;
+	state <= SFIFO(conv_integer(rd_ptr));
+	writes <= WFIFO(conv_integer(rd_ptr));
+
+end rtl;